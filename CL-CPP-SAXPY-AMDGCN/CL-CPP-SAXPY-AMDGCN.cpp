@@ -1,16 +1,19 @@
 // OpenCL includes
 #include <CL/opencl.hpp>
 
+// Embedded device code
+#include <saxpy.bc.hpp>
+
 // C++ Standard includes
 #include <vector>
 #include <algorithm>
 #include <iostream>
-#include <fstream>
 #include <ios>
 #include <chrono>
 #include <random>
-#include <filesystem>
 #include <execution>
+#include <string>
+#include <type_traits>
 
 namespace cl
 {
@@ -57,26 +60,19 @@ int main(int argc, char *argv[])
 
 		cl::CommandQueue queue{context, device, cl::QueueProperties::Profiling};
 
-		// Load program source
-		std::ifstream source_file{std::filesystem::canonical(argv[0]).parent_path().append("saxpy.bc"), std::ios::binary};
-		if (!source_file.is_open())
-			throw std::runtime_error{std::string{"Cannot open kernel intermediate."}};
-
-		// Create program and kernel
+		// Create program (from device code embedded at build time) and kernel
 		cl::Program program{
 			context,
 			{device},
-			cl::Program::Binaries{std::vector<unsigned char>(
-				std::istreambuf_iterator<char>{source_file},
-				std::istreambuf_iterator<char>{})}};
+			cl::Program::Binaries{std::vector<unsigned char>(saxpy_bc, saxpy_bc + saxpy_bc_size)}};
 
 		program.build({device});
 
 		auto saxpy = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer>(program, "saxpy");
 
 		// Init computation
-		const std::size_t length = std::size_t(std::pow(2u, 20u)); // 1M, cast denotes floating-to-integral conversion,
-																   //     promises no data is lost, silences compiler warning
+		const std::size_t length = argc > 3 ? std::stoull(argv[3]) : std::size_t(std::pow(2u, 20u)); // 1M, cast denotes floating-to-integral conversion,
+																										//     promises no data is lost, silences compiler warning
 		std::vector<cl_float> vec_x(length),
 			vec_y(length);
 		cl_float a = 2.0;
@@ -89,13 +85,28 @@ int main(int argc, char *argv[])
 		std::generate_n(std::begin(vec_x), length, prng);
 		std::generate_n(std::begin(vec_y), length, prng);
 
-		cl::Buffer buf_x{queue, std::begin(vec_x), std::end(vec_x), true},
-			buf_y{queue, std::begin(vec_y), std::end(vec_y), false};
+		cl::Buffer buf_x{context, CL_MEM_READ_ONLY, length * sizeof(cl_float)},
+			buf_y{context, CL_MEM_READ_WRITE, length * sizeof(cl_float)},
+			buf_y_grid{queue, std::begin(vec_y), std::end(vec_y), false}; // Input of the grid-stride variant
+
+		// Explicit dispatch of data before launch, timed like the kernels
+		cl::Event upload_x_event, upload_y_event;
+		queue.enqueueWriteBuffer(buf_x, CL_FALSE, 0, length * sizeof(cl_float), vec_x.data(), nullptr, &upload_x_event);
+		queue.enqueueWriteBuffer(buf_y, CL_FALSE, 0, length * sizeof(cl_float), vec_y.data(), nullptr, &upload_y_event);
 
 		// Launch kernels
 		cl::Event kernel_event{saxpy(cl::EnqueueArgs{queue, cl::NDRange{length}, cl::NullRange}, a, buf_x, buf_y)};
 		kernel_event.wait();
 
+		// Launch grid-stride variant, enough work-groups to occupy every compute unit a few times over
+		auto saxpy_grid = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer, cl_ulong>(program, "saxpy_grid");
+		const std::size_t grid_wgs = saxpy_grid.getKernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device),
+						  grid_size = std::min<std::size_t>(4 * device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * grid_wgs,
+															(length + grid_wgs - 1) / grid_wgs * grid_wgs);
+
+		cl::Event grid_kernel_event{saxpy_grid(cl::EnqueueArgs{queue, cl::NDRange{grid_size}, cl::NDRange{grid_wgs}}, a, buf_x, buf_y_grid, static_cast<cl_ulong>(length))};
+		grid_kernel_event.wait();
+
 		// Compute validation set on host
 		auto start = std::chrono::high_resolution_clock::now();
 
@@ -112,10 +123,78 @@ int main(int argc, char *argv[])
 
 		std::cout << "Host (validation) execution took: " << std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() << " us." << std::endl;
 
+		std::cout << "Host to device transfer took: " << (cl::util::get_duration<CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END, std::chrono::microseconds>(upload_x_event) + cl::util::get_duration<CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END, std::chrono::microseconds>(upload_y_event)).count() << " us." << std::endl;
+
 		std::cout << "Device (kernel) execution took: " << cl::util::get_duration<CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END, std::chrono::microseconds>(kernel_event).count() << " us." << std::endl;
 
+		std::cout << "Device (grid-stride kernel, " << grid_size << " work-items) execution took: " << cl::util::get_duration<CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END, std::chrono::microseconds>(grid_kernel_event).count() << " us." << std::endl;
+
+		// Shared Virtual Memory variants, same as in CL-CPP-SAXPY-SPV
+		cl_device_svm_capabilities svm_caps = 0;
+		try
+		{
+			svm_caps = device.getInfo<CL_DEVICE_SVM_CAPABILITIES>();
+		}
+		catch (cl::Error &)
+		{
+		} // Devices below OpenCL 2.0 don't recognize the query
+
+		cl::Context::setDefault(context);
+		cl::CommandQueue::setDefault(queue);
+
+		auto saxpy_svm = cl::KernelFunctor<cl_float, cl_float *, cl_float *>(program, "saxpy");
+
+		auto svm_variant = [&](auto trait, const std::string &name)
+		{
+			using allocator = cl::SVMAllocator<cl_float, decltype(trait)>;
+			constexpr bool coarse = std::is_same_v<decltype(trait), cl::SVMTraitCoarse<>>;
+
+			std::vector<cl_float, allocator> svm_x(vec_x.cbegin(), vec_x.cend(), allocator{context}),
+				svm_y(vec_y.cbegin(), vec_y.cend(), allocator{context});
+
+			std::vector<cl_float> ref(length);
+			std::transform(std::execution::par_unseq,
+						   svm_x.cbegin(), svm_x.cend(),
+						   svm_y.cbegin(),
+						   ref.begin(),
+						   [=](const cl_float &x, const cl_float &y)
+						   {
+							   return a * x + y;
+						   });
+
+			if constexpr (coarse)
+			{
+				cl::unmapSVM(svm_x);
+				cl::unmapSVM(svm_y);
+			}
+
+			cl::Event svm_kernel_event{saxpy_svm(cl::EnqueueArgs{queue, cl::NDRange{length}, cl::NullRange}, a, svm_x.data(), svm_y.data())};
+			svm_kernel_event.wait();
+
+			if constexpr (coarse)
+				cl::mapSVM(svm_y);
+
+			std::cout << "Device (" << name << " SVM kernel) execution took: " << cl::util::get_duration<CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END, std::chrono::microseconds>(svm_kernel_event).count() << " us." << std::endl;
+
+			if (!std::equal(svm_y.cbegin(), svm_y.cend(), ref.cbegin(), ref.cend()))
+				throw std::runtime_error{"Validation of " + name + " SVM variant failed."};
+		};
+
+		if (svm_caps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)
+			svm_variant(cl::SVMTraitCoarse<>{}, "coarse-grained");
+		else
+			std::cout << "Device doesn't support SVM, skipping SVM variants." << std::endl;
+
+		if (svm_caps & CL_DEVICE_SVM_FINE_GRAIN_BUFFER)
+			svm_variant(cl::SVMTraitFine<>{}, "fine-grained");
+		else if (svm_caps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)
+			std::cout << "Device doesn't support fine-grained SVM, skipping fine-grained variant." << std::endl;
+
 		// (Blocking) fetch of results (reuse storage of vec_x)
-		cl::copy(queue, buf_y, std::begin(vec_x), std::end(vec_x));
+		cl::Event download_event;
+		queue.enqueueReadBuffer(buf_y, CL_TRUE, 0, length * sizeof(cl_float), vec_x.data(), nullptr, &download_event);
+
+		std::cout << "Device to host transfer took: " << cl::util::get_duration<CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END, std::chrono::microseconds>(download_event).count() << " us." << std::endl;
 
 		// Validate (compute saxpy on host and match results)
 		auto markers = std::mismatch(std::begin(vec_x), std::end(vec_x),
@@ -124,8 +203,13 @@ int main(int argc, char *argv[])
 		if (markers.first != std::end(vec_x) ||
 			markers.second != std::end(vec_y))
 			throw std::runtime_error{"Validation failed."};
-		else
-			std::cout << "Validation passed." << std::endl;
+
+		cl::copy(queue, buf_y_grid, std::begin(vec_x), std::end(vec_x));
+
+		if (!std::equal(std::begin(vec_x), std::end(vec_x), std::begin(vec_y), std::end(vec_y)))
+			throw std::runtime_error{"Validation of grid-stride variant failed."};
+
+		std::cout << "Validation passed." << std::endl;
 	}
 	catch (cl::BuildError &error) // If kernel failed to build
 	{
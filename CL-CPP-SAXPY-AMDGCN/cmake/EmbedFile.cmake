@@ -0,0 +1,40 @@
+# Converts a file into a C++ header defining its contents as a byte array, so
+# it can be compiled into an executable.
+#
+# Usage:
+#
+#   cmake -D INPUT=<file> -D OUTPUT=<header> -D SYMBOL=<identifier> -P EmbedFile.cmake
+#
+# The header defines 'SYMBOL' (const unsigned char[]) and 'SYMBOL_size'. The
+# contents are not null-terminated. OUTPUT is only touched if it changes.
+
+foreach(Var IN ITEMS INPUT OUTPUT SYMBOL)
+  if(NOT DEFINED ${Var})
+    message(FATAL_ERROR "EmbedFile.cmake: ${Var} not set")
+  endif()
+endforeach()
+
+file(READ "${INPUT}" Contents HEX)
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," Contents "${Contents}")
+set(Line_Pattern "")
+foreach(Byte RANGE 1 16)
+  string(APPEND Line_Pattern "0x[0-9a-f][0-9a-f],")
+endforeach()
+string(REGEX REPLACE "(${Line_Pattern})" "\\1\n  " Contents "${Contents}")
+get_filename_component(Input_Name "${INPUT}" NAME)
+
+file(WRITE "${OUTPUT}.tmp"
+"#pragma once
+
+// Generated from ${Input_Name} by EmbedFile.cmake, do not edit.
+
+#include <cstddef>
+
+static const unsigned char ${SYMBOL}[] = {
+  ${Contents}
+};
+static const std::size_t ${SYMBOL}_size = sizeof(${SYMBOL});
+")
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+file(REMOVE "${OUTPUT}.tmp")
@@ -1,6 +1,9 @@
 // OpenCL includes
 #include <CL/opencl.hpp>
 
+// Embedded device code
+#include <saxpy.spv.hpp>
+
 // C++ Standard includes
 #include <vector>
 #include <algorithm>
@@ -11,6 +14,13 @@
 #include <random>
 #include <filesystem>
 #include <execution>
+#include <string>
+#include <sstream>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+#include <system_error>
+#include <type_traits>
 
 namespace cl
 {
@@ -21,6 +31,95 @@ namespace cl
 		{
 			return std::chrono::duration_cast<Dur>(std::chrono::nanoseconds{ ev.getProfilingInfo<To>() - ev.getProfilingInfo<From>() });
 		}
+
+		// Program binary cache, same as in CL-CPP-SAXPY
+		template <typename Range>
+		std::uint64_t fnv1a(const Range& data)
+		{
+			std::uint64_t hash = 14695981039346656037ull;
+
+			for (unsigned char c : data)
+			{
+				hash ^= c;
+				hash *= 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+		std::filesystem::path cache_dir(const char* exe)
+		{
+			if (const char* dir = std::getenv("CL_CPP_SAXPY_SPV_CACHE_DIR")) return dir;
+
+			std::error_code error;
+			const std::filesystem::path path{ exe };
+			const auto canonical = std::filesystem::canonical(path, error);
+
+			return !path.has_parent_path() || error ? std::filesystem::path{} : canonical.parent_path() / "cache";
+		}
+
+		template <typename Source>
+		std::pair<cl::Program, bool> build_cached(const cl::Context& context,
+		                                          const cl::Device& device,
+		                                          const Source& source,
+		                                          const std::string& options,
+		                                          const std::filesystem::path& cache_dir)
+		{
+			std::stringstream key, name;
+			key << device.getInfo<CL_DEVICE_NAME>() << '\n'
+			    << device.getInfo<CL_DRIVER_VERSION>() << '\n'
+			    << options << '\n'
+			    << std::hex << fnv1a(source);
+			name << std::hex << fnv1a(key.str()) << ".bin";
+
+			const auto path = cache_dir / name.str();
+
+			std::ifstream cache_file;
+			if (!cache_dir.empty()) cache_file.open(path, std::ios::binary);
+
+			if (cache_file.is_open())
+			{
+				std::string cached_key;
+				std::getline(cache_file, cached_key, '\0');
+
+				if (cached_key == key.str())
+				{
+					try
+					{
+						cl::Program program{ context, { device }, cl::Program::Binaries{ std::vector<unsigned char>(std::istreambuf_iterator<char>{ cache_file },
+						                                                                                            std::istreambuf_iterator<char>{}) } };
+						program.build({ device }, options.c_str());
+
+						return { program, true };
+					}
+					catch (cl::Error&) {} // Binary rejected by the runtime
+				}
+			}
+
+			cl::Program program{ context, source };
+			program.build({ device }, options.c_str());
+
+			if (cache_dir.empty()) return { program, false };
+
+			const auto program_devices = program.getInfo<CL_PROGRAM_DEVICES>();
+			const auto binary = program.getInfo<CL_PROGRAM_BINARIES>().at(std::distance(program_devices.cbegin(), std::find(program_devices.cbegin(), program_devices.cend(), device)));
+			auto temp = path;
+			temp += "." + std::to_string(std::random_device{}()) + ".tmp";
+
+			std::error_code error;
+			if (std::filesystem::create_directories(cache_dir, error); !error)
+			{
+				std::ofstream temp_file{ temp, std::ios::binary };
+				temp_file << key.str() << '\0';
+				temp_file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+				temp_file.close();
+
+				if (!temp_file.fail()) std::filesystem::rename(temp, path, error);
+				if (temp_file.fail() || error) std::filesystem::remove(temp, error);
+			}
+
+			return { program, false };
+		}
 	}
 }
 
@@ -72,27 +171,36 @@ int main(int argc, char* argv[])
 
 		cl::CommandQueue queue{ context, device, cl::QueueProperties::Profiling };
 
-		// Load program source
-		std::ifstream source_file{ std::filesystem::canonical(argv[0]).parent_path().append("saxpy.spv"), std::ios::binary };
-		if (!source_file.is_open())
-			throw std::runtime_error{ std::string{ "Cannot open kernel intermediate." } };
+		// Program intermediate embedded at build time
+		const std::vector<char> source(saxpy_spv, saxpy_spv + saxpy_spv_size);
 
-		// Create program and kernel
-		cl::Program program(
-			context,
-			std::vector<char>(
-				std::istreambuf_iterator<char>{ source_file },
-				std::istreambuf_iterator<char>{}
-			)
-		);
+		// Create program (reusing a cached binary if possible) and kernel
+		const auto cache_dir = cl::util::cache_dir(argv[0]);
+		auto timed_build = [&]()
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			auto result = cl::util::build_cached(context, device, source, "", cache_dir);
+			auto finish = std::chrono::high_resolution_clock::now();
+
+			std::cout <<
+				"Program " << (result.second ? "load from cache (warm start)" : "build from source (cold start)") << " took: " <<
+				std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count() <<
+				" ms." << std::endl;
+
+			return result;
+		};
+
+		auto built = timed_build();
+		cl::Program program = built.first;
 
-		program.build({ device });
+		if (!built.second) timed_build(); // Report warm start as well
 
 		auto saxpy = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer>(program, "saxpy");
 
 		// Init computation
-		const std::size_t length = std::size_t(std::pow(2u, 20u)); // 1M, cast denotes floating-to-integral conversion,
-		                                                           //     promises no data is lost, silences compiler warning
+		const std::size_t length = argc > 3 ? std::stoull(argv[3]) :
+		                                      std::size_t(std::pow(2u, 20u)); // 1M, cast denotes floating-to-integral conversion,
+		                                                                      //     promises no data is lost, silences compiler warning
 		std::vector<cl_float> vec_x(length),
 		                      vec_y(length);
 		cl_float a = 2.0;
@@ -104,13 +212,42 @@ int main(int argc, char* argv[])
 		std::generate_n(std::begin(vec_x), length, prng);
 		std::generate_n(std::begin(vec_y), length, prng);
 
-		cl::Buffer buf_x{ queue, std::begin(vec_x), std::end(vec_x), true },
-		           buf_y{ queue, std::begin(vec_y), std::end(vec_y), false };
+		cl::Buffer buf_x{ context, CL_MEM_READ_ONLY, length * sizeof(cl_float) },
+		           buf_y{ context, CL_MEM_READ_WRITE, length * sizeof(cl_float) },
+		           buf_y_vec{ queue, std::begin(vec_y), std::end(vec_y), false }, // Input of the vectorised variant
+		           buf_y_grid{ queue, std::begin(vec_y), std::end(vec_y), false }; // Input of the grid-stride variant
+
+		// Explicit dispatch of data before launch, timed like the kernels
+		cl::Event upload_x_event, upload_y_event;
+		queue.enqueueWriteBuffer(buf_x, CL_FALSE, 0, length * sizeof(cl_float), vec_x.data(), nullptr, &upload_x_event);
+		queue.enqueueWriteBuffer(buf_y, CL_FALSE, 0, length * sizeof(cl_float), vec_y.data(), nullptr, &upload_y_event);
 
 		// Launch kernels
 		cl::Event kernel_event{ saxpy(cl::EnqueueArgs{ queue, cl::NDRange{ length }, cl::NullRange }, a, buf_x, buf_y) };
 		kernel_event.wait();
 
+		// Launch vectorised variant matching the preferred vector width of the device (if any)
+		const cl_uint width = device.getInfo<CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT>();
+		const bool vectorised = width == 2 || width == 4 || width == 8 || width == 16;
+
+		cl::Event vec_kernel_event;
+		if (vectorised)
+		{
+			auto saxpy_vec = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer, cl_ulong>(program, "saxpy" + std::to_string(width));
+
+			vec_kernel_event = saxpy_vec(cl::EnqueueArgs{ queue, cl::NDRange{ (length + width - 1) / width }, cl::NullRange }, a, buf_x, buf_y_vec, static_cast<cl_ulong>(length));
+			vec_kernel_event.wait();
+		}
+
+		// Launch grid-stride variant, enough work-groups to occupy every compute unit a few times over
+		auto saxpy_grid = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer, cl_ulong>(program, "saxpy_grid");
+		const std::size_t grid_wgs = saxpy_grid.getKernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device),
+		                  grid_size = std::min<std::size_t>(4 * device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * grid_wgs,
+		                                                    (length + grid_wgs - 1) / grid_wgs * grid_wgs);
+
+		cl::Event grid_kernel_event{ saxpy_grid(cl::EnqueueArgs{ queue, cl::NDRange{ grid_size }, cl::NDRange{ grid_wgs } }, a, buf_x, buf_y_grid, static_cast<cl_ulong>(length)) };
+		grid_kernel_event.wait();
+
 		// Compute validation set on host
 		auto start = std::chrono::high_resolution_clock::now();
 
@@ -130,6 +267,16 @@ int main(int argc, char* argv[])
 			std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() <<
 			" us." << std::endl;
 
+		std::cout <<
+			"Host to device transfer took: " <<
+			(cl::util::get_duration<CL_PROFILING_COMMAND_START,
+			                        CL_PROFILING_COMMAND_END,
+			                        std::chrono::microseconds>(upload_x_event) +
+			 cl::util::get_duration<CL_PROFILING_COMMAND_START,
+			                        CL_PROFILING_COMMAND_END,
+			                        std::chrono::microseconds>(upload_y_event)).count() <<
+			" us." << std::endl;
+
 		std::cout <<
 			"Device (kernel) execution took: " <<
 			cl::util::get_duration<CL_PROFILING_COMMAND_START,
@@ -137,8 +284,93 @@ int main(int argc, char* argv[])
 			                       std::chrono::microseconds>(kernel_event).count() <<
 			" us." << std::endl;
 
+		if (vectorised)
+			std::cout <<
+				"Device (float" << width << " kernel) execution took: " <<
+				cl::util::get_duration<CL_PROFILING_COMMAND_START,
+				                       CL_PROFILING_COMMAND_END,
+				                       std::chrono::microseconds>(vec_kernel_event).count() <<
+				" us." << std::endl;
+		else
+			std::cout << "Device prefers scalar code, skipping vectorised variant." << std::endl;
+
+		std::cout <<
+			"Device (grid-stride kernel, " << grid_size << " work-items) execution took: " <<
+			cl::util::get_duration<CL_PROFILING_COMMAND_START,
+			                       CL_PROFILING_COMMAND_END,
+			                       std::chrono::microseconds>(grid_kernel_event).count() <<
+			" us." << std::endl;
+
+		// Shared Virtual Memory variants: coarse-grained allocations are handed over between host and device by
+		// (un)mapping them, fine-grained ones may be accessed by both directly
+		cl_device_svm_capabilities svm_caps = 0;
+		try { svm_caps = device.getInfo<CL_DEVICE_SVM_CAPABILITIES>(); }
+		catch (cl::Error&) {} // Devices below OpenCL 2.0 don't recognize the query
+
+		// SVM allocators and (un)mapping utilities implicitly use the default context and queue
+		cl::Context::setDefault(context);
+		cl::CommandQueue::setDefault(queue);
+
+		auto saxpy_svm = cl::KernelFunctor<cl_float, cl_float*, cl_float*>(program, "saxpy");
+
+		auto svm_variant = [&](auto trait, const std::string& name)
+		{
+			using allocator = cl::SVMAllocator<cl_float, decltype(trait)>;
+			constexpr bool coarse = std::is_same_v<decltype(trait), cl::SVMTraitCoarse<>>;
+
+			// Coarse-grained memory is allocated mapped for the host
+			std::vector<cl_float, allocator> svm_x(vec_x.cbegin(), vec_x.cend(), allocator{ context }),
+			                                 svm_y(vec_y.cbegin(), vec_y.cend(), allocator{ context });
+
+			// Compute validation set on host, reading the very allocations the device will
+			std::vector<cl_float> ref(length);
+			std::transform(std::execution::par_unseq,
+			               svm_x.cbegin(), svm_x.cend(),
+			               svm_y.cbegin(),
+			               ref.begin(),
+			               [=](const cl_float& x, const cl_float& y)
+			{
+				return a * x + y;
+			});
+
+			if constexpr (coarse) { cl::unmapSVM(svm_x); cl::unmapSVM(svm_y); }
+
+			cl::Event svm_kernel_event{ saxpy_svm(cl::EnqueueArgs{ queue, cl::NDRange{ length }, cl::NullRange }, a, svm_x.data(), svm_y.data()) };
+			svm_kernel_event.wait();
+
+			if constexpr (coarse) cl::mapSVM(svm_y);
+
+			std::cout <<
+				"Device (" << name << " SVM kernel) execution took: " <<
+				cl::util::get_duration<CL_PROFILING_COMMAND_START,
+				                       CL_PROFILING_COMMAND_END,
+				                       std::chrono::microseconds>(svm_kernel_event).count() <<
+				" us." << std::endl;
+
+			if (!std::equal(svm_y.cbegin(), svm_y.cend(), ref.cbegin(), ref.cend()))
+				throw std::runtime_error{ "Validation of " + name + " SVM variant failed." };
+		};
+
+		if (svm_caps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)
+			svm_variant(cl::SVMTraitCoarse<>{}, "coarse-grained");
+		else
+			std::cout << "Device doesn't support SVM, skipping SVM variants." << std::endl;
+
+		if (svm_caps & CL_DEVICE_SVM_FINE_GRAIN_BUFFER)
+			svm_variant(cl::SVMTraitFine<>{}, "fine-grained");
+		else if (svm_caps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)
+			std::cout << "Device doesn't support fine-grained SVM, skipping fine-grained variant." << std::endl;
+
 		// (Blocking) fetch of results (reuse storage of vec_x)
-		cl::copy(queue, buf_y, std::begin(vec_x), std::end(vec_x));
+		cl::Event download_event;
+		queue.enqueueReadBuffer(buf_y, CL_TRUE, 0, length * sizeof(cl_float), vec_x.data(), nullptr, &download_event);
+
+		std::cout <<
+			"Device to host transfer took: " <<
+			cl::util::get_duration<CL_PROFILING_COMMAND_START,
+			                       CL_PROFILING_COMMAND_END,
+			                       std::chrono::microseconds>(download_event).count() <<
+			" us." << std::endl;
 
 		// Validate (compute saxpy on host and match results)
 		auto markers = std::mismatch(std::begin(vec_x), std::end(vec_x),
@@ -146,8 +378,21 @@ int main(int argc, char* argv[])
 
 		if (markers.first != std::end(vec_x) ||
 		    markers.second != std::end(vec_y)) throw std::runtime_error{ "Validation failed." };
-		else
-			std::cout << "Validation passed." << std::endl;
+
+		if (vectorised)
+		{
+			cl::copy(queue, buf_y_vec, std::begin(vec_x), std::end(vec_x));
+
+			if (!std::equal(std::begin(vec_x), std::end(vec_x), std::begin(vec_y), std::end(vec_y)))
+				throw std::runtime_error{ "Validation of vectorised variant failed." };
+		}
+
+		cl::copy(queue, buf_y_grid, std::begin(vec_x), std::end(vec_x));
+
+		if (!std::equal(std::begin(vec_x), std::end(vec_x), std::begin(vec_y), std::end(vec_y)))
+			throw std::runtime_error{ "Validation of grid-stride variant failed." };
+
+		std::cout << "Validation passed." << std::endl;
 
 	}
 	catch (cl::BuildError& error) // If kernel failed to build
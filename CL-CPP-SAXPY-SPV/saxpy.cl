@@ -12,4 +12,41 @@ kernel void saxpy(
 
 	//y[gid] = axpy(a, x[gid], y[gid]);
 	y[gid] = a * x[gid] + y[gid];
-}
\ No newline at end of file
+}
+
+// Vectorised variants, every work-item processes N consecutive elements. The
+// work-item owning the partial block at the end of the input (if any) falls
+// back to scalar code. vloadN/vstoreN only require scalar alignment.
+#define SAXPY_VEC(N) \
+kernel void saxpy##N( \
+	float a, \
+	global float* x, \
+	global float* y, \
+	ulong length) \
+{ \
+	size_t gid = get_global_id(0), \
+	       first = gid * N; \
+\
+	if (first + N <= length) \
+		vstore##N(a * vload##N(gid, x) + vload##N(gid, y), gid, y); \
+	else \
+		for (size_t i = first ; i < length ; ++i) \
+			y[i] = a * x[i] + y[i]; \
+}
+
+SAXPY_VEC(2)
+SAXPY_VEC(4)
+SAXPY_VEC(8)
+SAXPY_VEC(16)
+
+// Grid-stride variant, launched with a fixed number of work-items independent
+// of the input length, every work-item looping over the input.
+kernel void saxpy_grid(
+	float a,
+	global float* x,
+	global float* y,
+	ulong length)
+{
+	for (size_t i = get_global_id(0) ; i < length ; i += get_global_size(0))
+		y[i] = a * x[i] + y[i];
+}
@@ -1,6 +1,9 @@
 // OpenCL includes
 #include <CL/opencl.hpp>
 
+// Embedded kernels
+#include <saxpy.cl.hpp>
+
 // C++ Standard includes
 #include <vector>
 #include <algorithm>
@@ -11,6 +14,12 @@
 #include <random>
 #include <filesystem>
 #include <execution>
+#include <string>
+#include <sstream>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+#include <system_error>
 
 namespace cl
 {
@@ -21,6 +30,107 @@ namespace cl
 		{
 			return std::chrono::duration_cast<Dur>(std::chrono::nanoseconds{ ev.getProfilingInfo<To>() - ev.getProfilingInfo<From>() });
 		}
+
+		/// Returns the 64-bit FNV-1a hash of the bytes of <c>data</c>.
+		template <typename Range>
+		std::uint64_t fnv1a(const Range& data)
+		{
+			std::uint64_t hash = 14695981039346656037ull;
+
+			for (unsigned char c : data)
+			{
+				hash ^= c;
+				hash *= 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+		/// Returns the program binary cache directory, which is <c>CL_CPP_SAXPY_CACHE_DIR</c> if set in the environment,
+		/// otherwise cache/ next to the executable started as <c>exe</c>. Returns an empty path if the
+		/// executable cannot be located (eg. started through PATH), which disables caching.
+		std::filesystem::path cache_dir(const char* exe)
+		{
+			if (const char* dir = std::getenv("CL_CPP_SAXPY_CACHE_DIR")) return dir;
+
+			std::error_code error;
+			const std::filesystem::path path{ exe };
+			const auto canonical = std::filesystem::canonical(path, error);
+
+			return !path.has_parent_path() || error ? std::filesystem::path{} : canonical.parent_path() / "cache";
+		}
+
+		/// Builds a program for <c>device</c> from <c>source</c> (source string or IL), reusing the binary
+		/// cached in <c>cache_dir</c> by a previous build of the same source with the same options on the
+		/// same device and driver. Returns the program and whether it was loaded from the cache.
+		///
+		/// NOTE: entries start with their full key, hash collisions and rejected binaries fall back to
+		///       building from source. An empty <c>cache_dir</c> disables caching.
+		template <typename Source>
+		std::pair<cl::Program, bool> build_cached(const cl::Context& context,
+		                                          const cl::Device& device,
+		                                          const Source& source,
+		                                          const std::string& options,
+		                                          const std::filesystem::path& cache_dir)
+		{
+			std::stringstream key, name;
+			key << device.getInfo<CL_DEVICE_NAME>() << '\n'
+			    << device.getInfo<CL_DRIVER_VERSION>() << '\n'
+			    << options << '\n'
+			    << std::hex << fnv1a(source);
+			name << std::hex << fnv1a(key.str()) << ".bin";
+
+			const auto path = cache_dir / name.str();
+
+			std::ifstream cache_file;
+			if (!cache_dir.empty()) cache_file.open(path, std::ios::binary);
+
+			if (cache_file.is_open())
+			{
+				std::string cached_key;
+				std::getline(cache_file, cached_key, '\0');
+
+				if (cached_key == key.str())
+				{
+					try
+					{
+						cl::Program program{ context, { device }, cl::Program::Binaries{ std::vector<unsigned char>(std::istreambuf_iterator<char>{ cache_file },
+						                                                                                            std::istreambuf_iterator<char>{}) } };
+						program.build({ device }, options.c_str());
+
+						return { program, true };
+					}
+					catch (cl::Error&) {} // Binary rejected by the runtime
+				}
+			}
+
+			cl::Program program{ context, source };
+			program.build({ device }, options.c_str());
+
+			if (cache_dir.empty()) return { program, false };
+
+			// Write a uniquely named temporary first, so concurrent runs never observe (or rename) partial entries
+			// Program may be associated with more devices of the context, binaries are listed in their order
+			const auto program_devices = program.getInfo<CL_PROGRAM_DEVICES>();
+			const auto binary = program.getInfo<CL_PROGRAM_BINARIES>().at(std::distance(program_devices.cbegin(), std::find(program_devices.cbegin(), program_devices.cend(), device)));
+			auto temp = path;
+			temp += "." + std::to_string(std::random_device{}()) + ".tmp";
+
+			// Caching is best-effort, entries which cannot be written (eg. read-only location) are skipped
+			std::error_code error;
+			if (std::filesystem::create_directories(cache_dir, error); !error)
+			{
+				std::ofstream temp_file{ temp, std::ios::binary };
+				temp_file << key.str() << '\0';
+				temp_file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+				temp_file.close();
+
+				if (!temp_file.fail()) std::filesystem::rename(temp, path, error);
+				if (temp_file.fail() || error) std::filesystem::remove(temp, error);
+			}
+
+			return { program, false };
+		}
 	}
 }
 
@@ -56,40 +166,212 @@ int main(int argc, char* argv[])
 
 		cl::CommandQueue queue{ context, device, cl::QueueProperties::Profiling };
 
-		// Load program source
-		std::ifstream source_file{ std::filesystem::canonical(argv[0]).parent_path().append("saxpy.cl") };
-		if (!source_file.is_open())
-			throw std::runtime_error{ std::string{ "Cannot open kernel source." } + std::filesystem::canonical(argv[0]).parent_path().append("saxpy.cl").string() };
+		// Program source embedded at build time
+		const std::string source{ reinterpret_cast<const char*>(saxpy_cl), saxpy_cl_size };
+
+		// Create program (reusing a cached binary if possible) and kernel
+		const auto cache_dir = cl::util::cache_dir(argv[0]);
+		auto timed_build = [&]()
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			auto result = cl::util::build_cached(context, device, source, "", cache_dir);
+			auto finish = std::chrono::high_resolution_clock::now();
+
+			std::cout <<
+				"Program " << (result.second ? "load from cache (warm start)" : "build from source (cold start)") << " took: " <<
+				std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count() <<
+				" ms." << std::endl;
+
+			return result;
+		};
 
-		// Create program and kernel
-		cl::Program program{ context, std::string{ std::istreambuf_iterator<char>{ source_file },
-		                                           std::istreambuf_iterator<char>{} } };
+		auto built = timed_build();
+		cl::Program program = built.first;
 
-		program.build({ device });
+		if (!built.second) timed_build(); // Report warm start as well
 
 		auto saxpy = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer>(program, "saxpy");
 
 		// Init computation
-		const std::size_t chainlength = std::size_t(std::pow(2u, 20u)); // 1M, cast denotes floating-to-integral conversion,
-		                                                                //     promises no data is lost, silences compiler warning
+		const std::size_t chainlength = argc > 3 ? std::stoull(argv[3]) :
+		                                           std::size_t(std::pow(2u, 20u)); // 1M, cast denotes floating-to-integral conversion,
+		                                                                           //     promises no data is lost, silences compiler warning
 		std::vector<cl_float> vec_x(chainlength),
 		                      vec_y(chainlength);
 		cl_float a = 2.0;
 
-		// Fill arrays with random values between 0 and 100
-		auto prng = [engine = std::default_random_engine{},
-		             distribution = std::uniform_real_distribution<cl_float>{ -100.0, 100.0 }]() mutable { return distribution(engine); };
+		// Fill arrays with random values between 0 and 100 (every generator made yields the same sequence)
+		auto make_prng = []()
+		{
+			return [engine = std::default_random_engine{},
+			        distribution = std::uniform_real_distribution<cl_float>{ -100.0, 100.0 }]() mutable { return distribution(engine); };
+		};
+		auto prng = make_prng();
 
 		std::generate_n(std::begin(vec_x), chainlength, prng);
 		std::generate_n(std::begin(vec_y), chainlength, prng);
 
-		cl::Buffer buf_x{ queue, std::begin(vec_x), std::end(vec_x), true },
-		           buf_y{ queue, std::begin(vec_y), std::end(vec_y), false };
+		cl::Buffer buf_x{ context, CL_MEM_READ_ONLY, chainlength * sizeof(cl_float) },
+		           buf_y{ context, CL_MEM_READ_WRITE, chainlength * sizeof(cl_float) },
+		           buf_y_vec{ queue, std::begin(vec_y), std::end(vec_y), false }, // Input of the vectorised variant
+		           buf_y_grid{ queue, std::begin(vec_y), std::end(vec_y), false }; // Input of the grid-stride variant
+
+		// Explicit dispatch of data before launch, timed like the kernels
+		cl::Event upload_x_event, upload_y_event;
+		queue.enqueueWriteBuffer(buf_x, CL_FALSE, 0, chainlength * sizeof(cl_float), vec_x.data(), nullptr, &upload_x_event);
+		queue.enqueueWriteBuffer(buf_y, CL_FALSE, 0, chainlength * sizeof(cl_float), vec_y.data(), nullptr, &upload_y_event);
 
 		// Launch kernels
 		cl::Event kernel_event{ saxpy(cl::EnqueueArgs{ queue, cl::NDRange{ chainlength }, cl::NullRange }, a, buf_x, buf_y) };
 		kernel_event.wait();
 
+		// Launch vectorised variant matching the preferred vector width of the device (if any)
+		const cl_uint width = device.getInfo<CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT>();
+		const bool vectorised = width == 2 || width == 4 || width == 8 || width == 16;
+
+		cl::Event vec_kernel_event;
+		if (vectorised)
+		{
+			auto saxpy_vec = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer, cl_ulong>(program, "saxpy" + std::to_string(width));
+
+			vec_kernel_event = saxpy_vec(cl::EnqueueArgs{ queue, cl::NDRange{ (chainlength + width - 1) / width }, cl::NullRange }, a, buf_x, buf_y_vec, static_cast<cl_ulong>(chainlength));
+			vec_kernel_event.wait();
+		}
+
+		// Launch grid-stride variant, enough work-groups to occupy every compute unit a few times over
+		auto saxpy_grid = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer, cl_ulong>(program, "saxpy_grid");
+		const std::size_t grid_wgs = saxpy_grid.getKernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device),
+		                  grid_size = std::min<std::size_t>(4 * device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * grid_wgs,
+		                                                    (chainlength + grid_wgs - 1) / grid_wgs * grid_wgs);
+
+		cl::Event grid_kernel_event{ saxpy_grid(cl::EnqueueArgs{ queue, cl::NDRange{ grid_size }, cl::NDRange{ grid_wgs } }, a, buf_x, buf_y_grid, static_cast<cl_ulong>(chainlength)) };
+		grid_kernel_event.wait();
+
+		// Streaming variant: the arrays are processed in chunks cycling through a ring of device buffers. Every stage
+		// (upload, compute, download) has its own in-order queue, ordering across stages is expressed by events, so
+		// uploading chunk k+1, computing chunk k and downloading chunk k-1 may overlap.
+		const std::size_t chunks = std::max<std::size_t>(argc > 4 ? std::stoull(argv[4]) : 16, 1),
+		                  chunk_length = (chainlength + chunks - 1) / chunks,
+		                  depth = 3; // Triple buffering, one slot per stage in flight
+
+		cl::CommandQueue upload{ context, device },
+		                 compute{ context, device },
+		                 download{ context, device };
+
+		std::vector<cl::Buffer> slot_x, slot_y;
+		for (std::size_t s = 0 ; s < depth ; ++s)
+		{
+			slot_x.emplace_back(context, CL_MEM_READ_ONLY, chunk_length * sizeof(cl_float));
+			slot_y.emplace_back(context, CL_MEM_READ_WRITE, chunk_length * sizeof(cl_float));
+		}
+
+		std::vector<cl_float> vec_y_stream(chainlength);
+
+		auto streamed = [&]()
+		{
+			std::vector<cl::Event> downloaded(chunks);
+
+			for (std::size_t k = 0 ; k < chunks && k * chunk_length < chainlength ; ++k)
+			{
+				const std::size_t first = k * chunk_length,
+				                  count = std::min(chunk_length, chainlength - first),
+				                  bytes = count * sizeof(cl_float),
+				                  s = k % depth;
+
+				// Slot may only be overwritten once the chunk previously occupying it has been fetched
+				std::vector<cl::Event> slot_free;
+				if (k >= depth) slot_free.push_back(downloaded[k - depth]);
+
+				std::vector<cl::Event> uploaded(2);
+				upload.enqueueWriteBuffer(slot_x[s], CL_FALSE, 0, bytes, vec_x.data() + first, &slot_free, &uploaded[0]);
+				upload.enqueueWriteBuffer(slot_y[s], CL_FALSE, 0, bytes, vec_y.data() + first, &slot_free, &uploaded[1]);
+				upload.flush();
+
+				std::vector<cl::Event> computed{ saxpy(cl::EnqueueArgs{ compute, uploaded, cl::NDRange{ count }, cl::NullRange }, a, slot_x[s], slot_y[s]) };
+				compute.flush();
+
+				download.enqueueReadBuffer(slot_y[s], CL_FALSE, 0, bytes, vec_y_stream.data() + first, &computed, &downloaded[k]);
+				download.flush();
+			}
+
+			download.finish();
+		};
+
+		// Serial baseline: upload everything, compute, download everything, each step waiting for the previous one
+		cl::Buffer serial_x{ context, CL_MEM_READ_ONLY, chainlength * sizeof(cl_float) },
+		           serial_y{ context, CL_MEM_READ_WRITE, chainlength * sizeof(cl_float) };
+
+		auto serial = [&]()
+		{
+			queue.enqueueWriteBuffer(serial_x, CL_TRUE, 0, chainlength * sizeof(cl_float), vec_x.data());
+			queue.enqueueWriteBuffer(serial_y, CL_TRUE, 0, chainlength * sizeof(cl_float), vec_y.data());
+			saxpy(cl::EnqueueArgs{ queue, cl::NDRange{ chainlength }, cl::NullRange }, a, serial_x, serial_y).wait();
+			queue.enqueueReadBuffer(serial_y, CL_TRUE, 0, chainlength * sizeof(cl_float), vec_y_stream.data());
+		};
+
+		// Best of a few runs, the first of which also warms up the buffers. Preparation before each run is not timed.
+		auto best_of = [](auto&& f, auto&&... prepare)
+		{
+			auto best = std::chrono::high_resolution_clock::duration::max();
+			for (int i = 0 ; i < 5 ; ++i)
+			{
+				(prepare(), ...);
+				auto start = std::chrono::high_resolution_clock::now();
+				f();
+				best = std::min(best, std::chrono::high_resolution_clock::now() - start);
+			}
+			return std::chrono::duration_cast<std::chrono::microseconds>(best);
+		};
+
+		const auto serial_time = best_of(serial),
+		           streamed_time = best_of(streamed); // Runs last, leaving its results in vec_y_stream
+
+		// Effective throughput counts every byte crossing the bus: x and y up, y down
+		auto throughput = [&](std::chrono::microseconds time)
+		{
+			return 3.0 * chainlength * sizeof(cl_float) / std::max<std::chrono::microseconds::rep>(time.count(), 1) * 1e-3; // GB/s
+		};
+
+		// Zero-copy variant: devices sharing memory with the host (such as CPUs) may directly access buffers allocated
+		// by the runtime in host memory. Inputs are produced directly into the mapped buffers (the same sequence as in
+		// vec_x and vec_y) and results read in place, hence no transfers take place.
+		const bool unified = device.getInfo<CL_DEVICE_HOST_UNIFIED_MEMORY>() == CL_TRUE;
+		const std::size_t bytes = chainlength * sizeof(cl_float);
+
+		cl::Buffer zc_x, zc_y;
+		std::chrono::microseconds zero_copy_time{};
+
+		if (unified)
+		{
+			zc_x = cl::Buffer{ context, CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, bytes };
+			zc_y = cl::Buffer{ context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bytes };
+
+			// Untimed, like generating vec_x and vec_y. Repeated before every run, as SAXPY overwrites y.
+			auto produce = [&]()
+			{
+				auto x = static_cast<cl_float*>(queue.enqueueMapBuffer(zc_x, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, bytes));
+				auto y = static_cast<cl_float*>(queue.enqueueMapBuffer(zc_y, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, bytes));
+				auto zc_prng = make_prng();
+				std::generate_n(x, chainlength, zc_prng);
+				std::generate_n(y, chainlength, zc_prng);
+				queue.enqueueUnmapMemObject(zc_x, x);
+				queue.enqueueUnmapMemObject(zc_y, y);
+				queue.finish();
+			};
+
+			auto zero_copy = [&]()
+			{
+				saxpy(cl::EnqueueArgs{ queue, cl::NDRange{ chainlength }, cl::NullRange }, a, zc_x, zc_y);
+
+				// Results are readable in place for as long as the mapping lives
+				auto y = static_cast<cl_float*>(queue.enqueueMapBuffer(zc_y, CL_TRUE, CL_MAP_READ, 0, bytes));
+				queue.enqueueUnmapMemObject(zc_y, y);
+				queue.finish();
+			};
+
+			zero_copy_time = best_of(zero_copy, produce);
+		}
+
 		clReleaseEvent(kernel_event());
 		cl::Event another_event = kernel_event;
 
@@ -112,6 +394,16 @@ int main(int argc, char* argv[])
 			std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() <<
 			" us." << std::endl;
 
+		std::cout <<
+			"Host to device transfer took: " <<
+			(cl::util::get_duration<CL_PROFILING_COMMAND_START,
+			                        CL_PROFILING_COMMAND_END,
+			                        std::chrono::microseconds>(upload_x_event) +
+			 cl::util::get_duration<CL_PROFILING_COMMAND_START,
+			                        CL_PROFILING_COMMAND_END,
+			                        std::chrono::microseconds>(upload_y_event)).count() <<
+			" us." << std::endl;
+
 		std::cout <<
 			"Device (kernel) execution took: " <<
 			cl::util::get_duration<CL_PROFILING_COMMAND_START,
@@ -119,8 +411,45 @@ int main(int argc, char* argv[])
 			                       std::chrono::microseconds>(kernel_event).count() <<
 			" us." << std::endl;
 
+		if (vectorised)
+			std::cout <<
+				"Device (float" << width << " kernel) execution took: " <<
+				cl::util::get_duration<CL_PROFILING_COMMAND_START,
+				                       CL_PROFILING_COMMAND_END,
+				                       std::chrono::microseconds>(vec_kernel_event).count() <<
+				" us." << std::endl;
+		else
+			std::cout << "Device prefers scalar code, skipping vectorised variant." << std::endl;
+
+		std::cout <<
+			"Device (grid-stride kernel, " << grid_size << " work-items) execution took: " <<
+			cl::util::get_duration<CL_PROFILING_COMMAND_START,
+			                       CL_PROFILING_COMMAND_END,
+			                       std::chrono::microseconds>(grid_kernel_event).count() <<
+			" us." << std::endl;
+
+		std::cout <<
+			"Serial transfer + compute took: " << serial_time.count() << " us (" << throughput(serial_time) << " GB/s)." << std::endl <<
+			"Streamed transfer + compute (" << chunks << " chunks, " << depth << " slots) took: " << streamed_time.count() << " us (" << throughput(streamed_time) << " GB/s, " <<
+			static_cast<double>(serial_time.count()) / std::max<std::chrono::microseconds::rep>(streamed_time.count(), 1) << "x)." << std::endl;
+
+		if (unified)
+			std::cout <<
+				"Zero-copy (mapped host memory) transfer + compute took: " << zero_copy_time.count() << " us (" <<
+				static_cast<double>(serial_time.count()) / std::max<std::chrono::microseconds::rep>(zero_copy_time.count(), 1) << "x speedup over serial)." << std::endl;
+		else
+			std::cout << "Device does not share memory with the host, skipping zero-copy variant." << std::endl;
+
 		// (Blocking) fetch of results (reuse storage of vec_x)
-		cl::copy(queue, buf_y, std::begin(vec_x), std::end(vec_x));
+		cl::Event download_event;
+		queue.enqueueReadBuffer(buf_y, CL_TRUE, 0, chainlength * sizeof(cl_float), vec_x.data(), nullptr, &download_event);
+
+		std::cout <<
+			"Device to host transfer took: " <<
+			cl::util::get_duration<CL_PROFILING_COMMAND_START,
+			                       CL_PROFILING_COMMAND_END,
+			                       std::chrono::microseconds>(download_event).count() <<
+			" us." << std::endl;
 
 		// Validate (compute saxpy on host and match results)
 		auto markers = std::mismatch(std::begin(vec_x), std::end(vec_x),
@@ -129,6 +458,32 @@ int main(int argc, char* argv[])
 		if (markers.first != std::end(vec_x) ||
 		    markers.second != std::end(vec_y)) throw std::runtime_error{ "Validation failed." };
 
+		if (vectorised)
+		{
+			cl::copy(queue, buf_y_vec, std::begin(vec_x), std::end(vec_x));
+
+			if (!std::equal(std::begin(vec_x), std::end(vec_x), std::begin(vec_y), std::end(vec_y)))
+				throw std::runtime_error{ "Validation of vectorised variant failed." };
+		}
+
+		cl::copy(queue, buf_y_grid, std::begin(vec_x), std::end(vec_x));
+
+		if (!std::equal(std::begin(vec_x), std::end(vec_x), std::begin(vec_y), std::end(vec_y)))
+			throw std::runtime_error{ "Validation of grid-stride variant failed." };
+
+		if (!std::equal(std::begin(vec_y_stream), std::end(vec_y_stream), std::begin(vec_y), std::end(vec_y)))
+			throw std::runtime_error{ "Validation of streaming variant failed." };
+
+		if (unified)
+		{
+			auto y = static_cast<cl_float*>(queue.enqueueMapBuffer(zc_y, CL_TRUE, CL_MAP_READ, 0, bytes));
+			const bool valid = std::equal(y, y + chainlength, std::begin(vec_y), std::end(vec_y));
+			queue.enqueueUnmapMemObject(zc_y, y);
+			queue.finish();
+
+			if (!valid) throw std::runtime_error{ "Validation of zero-copy variant failed." };
+		}
+
 	}
 	catch (cl::BuildError& error) // If kernel failed to build
 	{
@@ -5,11 +5,23 @@
 #include <algorithm>
 #include <array>
 #include <vector>
+#include <deque>
 #include <future>
 #include <iterator>
 #include <complex>
 #include <random>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <numeric>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <atomic>
+#include <cstdint>
+#include <tuple>
+#include <cstdlib>
+#include <cstring>
 
 // OpenCL C++ includes
 #define CL_HPP_ENABLE_EXCEPTIONS
@@ -60,7 +72,8 @@ namespace cl
 									 cl::Buffer& outputBuffer = tmp,
 									 cl::Buffer& tmpBuffer = tmp)
 		{
-			std::vector<cl_event> cl_waitEvents(waitEvents.size());
+			std::vector<cl_event> cl_waitEvents;
+			cl_waitEvents.reserve(waitEvents.size());
 			std::transform(waitEvents.cbegin(), waitEvents.cend(), std::back_inserter(cl_waitEvents), [](const cl::Event& evnt) {return evnt();});
 
 			return clfftEnqueueTransform(plHandle,
@@ -76,9 +89,129 @@ namespace cl
 										 outputBuffer() != cl::Buffer()() ? &outputBuffer() : nullptr,
 										 tmpBuffer() != cl::Buffer()() ? tmpBuffer() : static_cast<cl_mem>(NULL));
 		}
+
+		// Everything a baked plan depends on, apart from the device
+		struct PlanDesc
+		{
+			clfftDim dim;
+			std::vector<std::size_t> lengths;
+			std::size_t batch;
+			clfftPrecision precision;
+			clfftLayout inLayout, outLayout;
+			clfftResultLocation placement;
+			std::vector<std::size_t> inStrides, outStrides; // Empty for default (packed) strides
+			std::size_t inDistance = 0, outDistance = 0;    // Zero for default (packed) distances
+		};
+
+		inline bool operator<(const PlanDesc& lhs, const PlanDesc& rhs)
+		{
+			return std::tie(lhs.dim, lhs.lengths, lhs.batch, lhs.precision, lhs.inLayout, lhs.outLayout, lhs.placement, lhs.inStrides, lhs.outStrides, lhs.inDistance, lhs.outDistance) <
+			       std::tie(rhs.dim, rhs.lengths, rhs.batch, rhs.precision, rhs.inLayout, rhs.outLayout, rhs.placement, rhs.inStrides, rhs.outStrides, rhs.inDistance, rhs.outDistance);
+		}
+
+		// Creates and bakes plans on first request, handing out the same plan for recurring shapes on the same device (and context)
+		// afterwards. Baking JIT-compiles kernels, which clFFT itself persists across runs if the CLFFT_CACHE_PATH
+		// environment variable names a directory when the library is loaded.
+		class PlanCache
+		{
+		public:
+
+			PlanCache() : hits(0), misses(0) {}
+			PlanCache(const PlanCache&) = delete;
+			~PlanCache() { clear(); }
+
+			clfftPlanHandle get(const PlanDesc& desc, cl::CommandQueue& queue)
+			{
+				cl_int err = CL_SUCCESS;
+				cl::Device device = queue.getInfo<CL_QUEUE_DEVICE>(&err); checkerr(err, "cl::CommandQueue::getInfo(CL_QUEUE_DEVICE)");
+				cl::Context context = queue.getInfo<CL_QUEUE_CONTEXT>(&err); checkerr(err, "cl::CommandQueue::getInfo(CL_QUEUE_CONTEXT)");
+
+				std::lock_guard<std::mutex> lock(mutex);
+
+				auto it = plans.find(std::make_tuple(context(), device(), desc));
+				if (it != plans.end())
+				{
+					++hits;
+					return it->second;
+				}
+
+				clfftPlanHandle plan;
+				err = clfftCreateDefaultPlan(&plan, context(), desc.dim, desc.lengths.data()); checkerr(err, "clCreateDefaultPlan");
+
+				err = clfftSetPlanBatchSize(plan, desc.batch); checkerr(err, "clfftSetPlanBatchSize");
+				err = clfftSetPlanPrecision(plan, desc.precision); checkerr(err, "clfftSetPlanPrecision");
+				err = clfftSetLayout(plan, desc.inLayout, desc.outLayout); checkerr(err, "clfftSetLayout");
+				err = clfftSetResultLocation(plan, desc.placement); checkerr(err, "clfftSetResultLocation");
+				if (!desc.inStrides.empty())
+				{
+					err = clfftSetPlanInStride(plan, desc.dim, const_cast<std::size_t*>(desc.inStrides.data())); checkerr(err, "clfftSetPlanInStride");
+				}
+				if (!desc.outStrides.empty())
+				{
+					err = clfftSetPlanOutStride(plan, desc.dim, const_cast<std::size_t*>(desc.outStrides.data())); checkerr(err, "clfftSetPlanOutStride");
+				}
+				if (desc.inDistance != 0 || desc.outDistance != 0)
+				{
+					err = clfftSetPlanDistance(plan, desc.inDistance, desc.outDistance); checkerr(err, "clfftSetPlanDistance");
+				}
+
+				// Bake plan
+				err = bakePlan(plan, queue); checkerr(err, "clfftBakePlan");
+
+				++misses;
+				plans.insert({ std::make_tuple(context(), device(), desc), plan });
+
+				return plan;
+			}
+
+			// Destroys all plans, must precede clfftTeardown
+			void clear()
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				for (auto& plan : plans) clfftDestroyPlan(&plan.second);
+				plans.clear();
+			}
+
+			std::size_t hits, misses;
+
+		private:
+
+			std::mutex mutex;
+			std::map<std::tuple<cl_context, cl_device_id, PlanDesc>, clfftPlanHandle> plans;
+		};
 	}
 } // namescpace cl
 
+// Fills data with values of dist, using threads on all cores. Every block of block_size elements is generated by an
+// engine of its own, seeded by seed and the index of the block, hence the result doesn't depend on the thread count.
+template <typename T, typename Distribution>
+void parallel_generate(std::vector<T>& data, const Distribution& dist, std::uint32_t seed, std::size_t block_size = std::size_t{ 1 } << 20)
+{
+	const std::size_t blocks = (data.size() + block_size - 1) / block_size;
+	std::atomic<std::size_t> next{ 0 };
+
+	auto work = [&]()
+	{
+		for (std::size_t b = next++; b < blocks; b = next++)
+		{
+			std::seed_seq seq{ seed, static_cast<std::uint32_t>(b), static_cast<std::uint32_t>(static_cast<std::uint64_t>(b) >> 32) };
+			std::default_random_engine prng(seq);
+			Distribution d = dist; // Distributions may hold state too
+
+			std::generate(data.begin() + b * block_size,
+						  data.begin() + std::min(data.size(), (b + 1) * block_size),
+						  [&]() { return d(prng); });
+		}
+	};
+
+	std::vector<std::future<void>> futures;
+	for (unsigned int i = 0; i < std::max(1u, std::thread::hardware_concurrency()); ++i)
+		futures.push_back(std::async(std::launch::async, work));
+
+	for (auto& future : futures) future.get();
+}
+
 class Workflow
 {
 public:
@@ -117,3 +250,90 @@ void report_workflow_stage(const std::string& message, const std::vector<Workflo
 		std::cout << "\t" << std::chrono::duration_cast<std::chrono::milliseconds>(cl::event_time_elapsed<From, To>(flow.events.at(Event))).count() << " milliseconds." << std::endl;
 	std::cout << std::endl;
 }
+
+// Reports the time every device spent in the given stage. Stages of different sub-batches may overlap, hence time is
+// measured as the union of their [From, To] intervals (busy time), not their sum.
+template <Workflow::Events Event, cl_bitfield From, cl_bitfield To>
+void report_workflow_stage(const std::string& message, const std::vector<std::vector<Workflow>>& workflows)
+{
+	std::vector<std::chrono::nanoseconds> totals;
+	for (auto& flows : workflows)
+	{
+		std::vector<std::pair<cl_ulong, cl_ulong>> intervals;
+		for (auto& flow : flows)
+			intervals.emplace_back(flow.events.at(Event).getProfilingInfo<From>(), flow.events.at(Event).getProfilingInfo<To>());
+
+		std::sort(intervals.begin(), intervals.end());
+
+		cl_ulong busy = 0, covered = 0; // Covered up to this point in time
+		for (auto& interval : intervals)
+		{
+			const cl_ulong from = std::max(interval.first, covered);
+
+			if (interval.second > from) busy += interval.second - from;
+			covered = std::max(covered, interval.second);
+		}
+
+		totals.push_back(std::chrono::nanoseconds(busy));
+	}
+
+	std::cout << message << " = " << std::chrono::duration_cast<std::chrono::milliseconds>(*std::max_element(totals.cbegin(), totals.cend())).count() << " milliseconds.\n" << std::endl;
+	for (auto& total : totals)
+		std::cout << "\t" << std::chrono::duration_cast<std::chrono::milliseconds>(total).count() << " milliseconds." << std::endl;
+	std::cout << std::endl;
+}
+
+// Hands out consecutive units of work to devices on request. Devices claim a share of the remaining work proportional
+// to their measured throughput, halved so that the tail is split among all devices (guided self-scheduling). Devices
+// are probed with a single unit until their throughput is known.
+class Scheduler
+{
+public:
+
+	Scheduler(std::size_t units, std::size_t devices) : next(0), units(units), throughputs(devices, 0.0) {}
+	Scheduler(const Scheduler&) = delete;
+	~Scheduler() = default;
+
+	// Returns the first unit and the number of units claimed, the latter being zero once all work is handed out
+	std::pair<std::size_t, std::size_t> claim(std::size_t device)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		const std::size_t remaining = units - next;
+		if (remaining == 0) return { units, 0 };
+
+		std::size_t count = 1;
+		if (throughputs.at(device) > 0)
+		{
+			// Devices yet to be measured are assumed to be average
+			std::size_t measured = 0;
+			double sum = 0;
+			for (auto throughput : throughputs)
+				if (throughput > 0) { sum += throughput; ++measured; }
+
+			const double total = sum + (throughputs.size() - measured) * sum / measured;
+
+			count = static_cast<std::size_t>(std::ceil(remaining * throughputs.at(device) / total / 2));
+		}
+		count = std::min(std::max<std::size_t>(count, 1), remaining);
+
+		std::pair<std::size_t, std::size_t> result{ next, count };
+		next += count;
+
+		return result;
+	}
+
+	// Records that device processed the given number of units in elapsed time
+	void report(std::size_t device, std::size_t count, std::chrono::nanoseconds elapsed)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		throughputs.at(device) = count / std::chrono::duration<double>(elapsed).count();
+	}
+
+private:
+
+	std::mutex mutex;
+	std::size_t next, units;
+	std::vector<double> throughputs; // Units per second
+};
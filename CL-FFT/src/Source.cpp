@@ -1,14 +1,19 @@
 #include <Header.hpp>
 
-int main()
+int main(int argc, char* argv[])
 {
 	// Test params
 	std::size_t batch = 64;
 	std::size_t N = 1024;
+	std::size_t sub_batch = 4; // Transforms per unit of work handed out to devices
+	std::size_t depth = 3;     // Device buffers (of sub_batch transforms each) per device, 1 disables overlap
+	bool hermitian = argc > 1 && std::strcmp(argv[1], "r2c") == 0; // Real input transformed to its Hermitian half (R2C),
+	                                                                 // otherwise complex (C2C) in-place (default)
 
 	// Host side container and init
-	std::vector<std::complex<float>> x;
-	std::vector<std::default_random_engine> prngs;
+	std::vector<std::complex<float>> x; // Complex input and result (C2C)
+	std::vector<float> xr;              // Real input (R2C)
+	std::vector<std::complex<float>> y; // Hermitian result (R2C), N * (N / 2 + 1) values per transform
 	std::uniform_real_distribution<float> dist;
 
 	// OpenCL variables
@@ -19,14 +24,17 @@ int main()
 	std::vector<cl::Device> devices;
 	std::array<cl_context_properties, 3> cprops;
 	cl::Context context;
-	std::vector<cl::CommandQueue> queues;
-	std::vector<cl::Buffer> bufs_x;
-	std::vector<Workflow> workflows;
+	std::vector<cl::CommandQueue> queues;          // Per device, transforms
+	std::vector<cl::CommandQueue> upload_queues;   // Per device, host-device copies
+	std::vector<cl::CommandQueue> download_queues; // Per device, device-host copies
+	std::vector<std::vector<cl::Buffer>> bufs_x; // Per device, ring of depth buffers
+	std::vector<std::vector<cl::Buffer>> bufs_y; // Out-of-place results matching bufs_x (R2C only)
+	std::vector<std::vector<Workflow>> workflows;
+	std::vector<std::size_t> transforms;
 
 	// clFFT variables
-	std::vector<clfftPlanHandle> plans;
-	clfftDim dim;
-	std::array<std::size_t, 2> clLengths;
+	cl::fft::PlanCache plans;
+	cl::fft::PlanDesc desc;
 	clfftSetupData fftSetup;
 
 	// OpenCL initialization
@@ -51,7 +59,31 @@ int main()
 	std::cout << "Selected platform:\n\n\t" << platform.getInfo<CL_PLATFORM_NAME>() << "\n" << std::endl;
 
 	platform.getDevices(dev_type, &devices);
-	devices.resize(1);
+
+	// Partition devices along NUMA boundaries where possible, sub-devices are scheduled just like devices
+	{
+		std::vector<cl::Device> leaves;
+		for (auto& device : devices)
+		{
+			std::vector<cl::Device> subs;
+			auto partitions = device.getInfo<CL_DEVICE_PARTITION_PROPERTIES>(&err); checkerr(err, "cl::Device::getInfo(CL_DEVICE_PARTITION_PROPERTIES)");
+
+			if (std::find(partitions.cbegin(), partitions.cend(), CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN) != partitions.cend() &&
+				(device.getInfo<CL_DEVICE_PARTITION_AFFINITY_DOMAIN>() & CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE))
+			{
+				const cl_device_partition_property props[] = { CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN, CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE, 0 };
+
+				err = device.createSubDevices(props, &subs); checkerr(err, "cl::Device::createSubDevices");
+			}
+
+			if (subs.size() > 1)
+				leaves.insert(leaves.end(), subs.cbegin(), subs.cend());
+			else
+				leaves.push_back(device);
+		}
+		devices = leaves;
+	}
+
 	std::cout << "Selected devices:\n\n";
 	for (auto& device : devices)
 		std::cout << "\t" << device.getInfo<CL_DEVICE_NAME>() << std::endl;
@@ -61,126 +93,268 @@ int main()
 
 	context = cl::Context(devices, cprops.data(), nullptr, nullptr, &err); checkerr(err, "cl::Context::Context");
 
+	// Every stage has in-order queues of its own, ordering across stages is expressed by events, so that transfers of
+	// one sub-batch overlap the transform of another. Out-of-order execution of the transform queue is optional.
 	queues.resize(devices.size());
-	std::transform(devices.cbegin(), devices.cend(), queues.begin(), [&context](const cl::Device& dev) { return cl::CommandQueue(context, dev, CL_QUEUE_PROFILING_ENABLE/* | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE*/); });
+	std::transform(devices.cbegin(), devices.cend(), queues.begin(), [&context](const cl::Device& dev)
+	{
+		const bool ooo = dev.getInfo<CL_DEVICE_QUEUE_PROPERTIES>() & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+
+		return cl::CommandQueue(context, dev, CL_QUEUE_PROFILING_ENABLE | (ooo ? CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE : 0));
+	});
 
-	if (batch % devices.size() != 0)
+	for (auto* stage_queues : { &upload_queues, &download_queues })
 	{
-		std::cerr << "Device count is not a divisor of batch size. Exiting..." << std::endl;
-		exit(EXIT_FAILURE);
+		stage_queues->resize(devices.size());
+		std::transform(devices.cbegin(), devices.cend(), stage_queues->begin(), [&context](const cl::Device& dev)
+		{
+			return cl::CommandQueue(context, dev, CL_QUEUE_PROFILING_ENABLE);
+		});
 	}
 
+	// Bytes per transform of input and result, real input and the Hermitian half of its transform take about half as much
+	const std::size_t in_bytes = hermitian ? N * N * sizeof(float) : N * N * sizeof(std::complex<float>),
+	                  out_bytes = hermitian ? N * (N / 2 + 1) * sizeof(std::complex<float>) : in_bytes;
+
+	// Device memory use is bounded by the ring, independent of batch size
 	bufs_x.resize(devices.size());
-	for (auto& buf : bufs_x)
+	for (auto& ring : bufs_x)
 	{
-		buf = cl::Buffer(context, CL_MEM_READ_WRITE, batch / devices.size() * N * N * sizeof(std::complex<float>), nullptr, &err); checkerr(err, "cl::Buffer::Buffer");
+		ring.resize(depth);
+		for (auto& buf : ring)
+		{
+			buf = cl::Buffer(context, CL_MEM_READ_WRITE, sub_batch * in_bytes, nullptr, &err); checkerr(err, "cl::Buffer::Buffer");
+		}
+	}
+
+	if (hermitian)
+	{
+		bufs_y.resize(devices.size());
+		for (auto& ring : bufs_y)
+		{
+			ring.resize(depth);
+			for (auto& buf : ring)
+			{
+				buf = cl::Buffer(context, CL_MEM_READ_WRITE, sub_batch * out_bytes, nullptr, &err); checkerr(err, "cl::Buffer::Buffer");
+			}
+		}
 	}
 
 	// Host-side initialization
 	std::cout << "Generating random input" << std::endl;
 
-	// Single threaded
-    prngs.push_back(std::default_random_engine{});
-	std::generate_n(std::back_inserter(x),
-                    batch * N * N,
-                    [=]() mutable { return dist(prngs.at(0)); });
-
-	// Multi-threaded
-	//{
-	//	std::vector<std::future<void>> futures;
-	//	std::vector<std::vector<std::complex<float>>> temps(std::thread::hardware_concurrency());
-	//	prngs.resize(std::thread::hardware_concurrency());
-    //
-	//	for (unsigned int i = 0; i < std::thread::hardware_concurrency(); ++i)
-	//		futures.push_back(std::async(std::launch::async, [=](std::reference_wrapper<std::vector<std::complex<float>>> temp, std::default_random_engine& prng, std::uniform_real_distribution<float> dist)
-	//		{
-	//			std::generate_n(std::back_inserter(temp.get()), batch * N * N / std::thread::hardware_concurrency(), [&prng, &dist]() { return dist(prng); });
-	//		}, std::ref(temps.at(i)), prngs.at(i), dist));
-    //
-	//	for (auto& future : futures) future.wait();
-	//	for (auto& temp : temps) x.insert(x.end(), temp.begin(), temp.end());
-	//}
+	{
+		auto gen_start = std::chrono::high_resolution_clock::now();
+
+		if (hermitian)
+		{
+			xr.resize(batch * N * N);
+			parallel_generate(xr, dist, 0u);
+			y.resize(batch * N * (N / 2 + 1));
+		}
+		else
+		{
+			x.resize(batch * N * N);
+			parallel_generate(x, dist, 0u);
+		}
+
+		auto gen_end = std::chrono::high_resolution_clock::now();
+
+		std::cout << "Generating random input took " << std::chrono::duration_cast<std::chrono::milliseconds>(gen_end - gen_start).count() << " milliseconds." << std::endl;
+	}
 
 	// clFFT initialization
 	std::cout << "Initializing clFFT" << std::endl;
-	dim = CLFFT_2D;
-	clLengths = { N, N };
+	desc.dim = CLFFT_2D;
+	desc.lengths = { N, N };
+	desc.precision = CLFFT_SINGLE;
+	if (hermitian)
+	{
+		// Out-of-place, packed rows of N reals in, N / 2 + 1 complex values out
+		desc.inLayout = CLFFT_REAL;
+		desc.outLayout = CLFFT_HERMITIAN_INTERLEAVED;
+		desc.placement = CLFFT_OUTOFPLACE;
+		desc.inStrides = { 1, N };
+		desc.outStrides = { 1, N / 2 + 1 };
+		desc.inDistance = N * N;
+		desc.outDistance = N * (N / 2 + 1);
+	}
+	else
+	{
+		desc.inLayout = CLFFT_COMPLEX_INTERLEAVED;
+		desc.outLayout = CLFFT_COMPLEX_INTERLEAVED;
+		desc.placement = CLFFT_INPLACE;
+	}
+
+	if (const char* path = std::getenv("CLFFT_CACHE_PATH"))
+		std::cout << "clFFT kernel binaries are cached in: " << path << std::endl;
+	else
+		std::cout << "Set CLFFT_CACHE_PATH to a directory to cache clFFT kernel binaries across runs" << std::endl;
 
 	err = clfftInitSetupData(&fftSetup); checkerr(err, "clfftInitSetupData");
 	err = clfftSetup(&fftSetup); checkerr(err, "clffftSetup");
 
-	plans.resize(devices.size());
-	for (std::size_t i = 0; i < plans.size(); ++i)
+	// Every unit of work is a full sub-batch, except for the remainder (if any). Plans are baked ahead of time, so
+	// that workers find them in the cache.
 	{
-		err = clfftCreateDefaultPlan(&plans.at(i), context(), dim, clLengths.data()); checkerr(err, "clCreateDefaultPlan");
+		auto bake_start = std::chrono::high_resolution_clock::now();
+
+		for (std::size_t i = 0; i < devices.size(); ++i)
+			for (std::size_t size : { sub_batch, batch % sub_batch })
+			{
+				if (size == 0) continue;
+
+				desc.batch = size;
+				plans.get(desc, queues.at(i));
+			}
 
-		err = clfftSetPlanBatchSize(plans.at(i), batch / devices.size()); checkerr(err, "clfftSetPlanBatchSize");
-		err = clfftSetPlanPrecision(plans.at(i), CLFFT_SINGLE); checkerr(err, "clfftSetPlanPrecision");
-		err = clfftSetLayout(plans.at(i), CLFFT_COMPLEX_INTERLEAVED, CLFFT_COMPLEX_INTERLEAVED); checkerr(err, "clfftSetLayout");
-		err = clfftSetResultLocation(plans.at(i), CLFFT_INPLACE); checkerr(err, "clfftSetResultLocation");
+		auto bake_end = std::chrono::high_resolution_clock::now();
 
-		// Bake plan
-		err = cl::fft::bakePlan(plans.at(i), queues.at(i)); checkerr(err, "clfftBakePlan");
+		std::cout << "Baking " << plans.misses << " plan(s) took " << std::chrono::duration_cast<std::chrono::milliseconds>(bake_end - bake_start).count() << " milliseconds." << std::endl;
 	}
 
+	// Host side input and result, the latter overwriting the former if transforming in-place (C2C)
+	char* in_host = hermitian ? reinterpret_cast<char*>(xr.data()) : reinterpret_cast<char*>(x.data());
+	char* out_host = hermitian ? reinterpret_cast<char*>(y.data()) : in_host;
+
 	// Start time
-	std::cout << "Starting " << batch << " count " << N << " * " << N << " std::complex<float> FFTs" << std::endl;
+	std::cout << "Starting " << batch << " count " << N << " * " << N << (hermitian ? " real-to-complex" : " std::complex<float>") << " FFTs in sub-batches of " << sub_batch << " through " << depth << " buffers per device on " << devices.size() << " device(s)" << std::endl;
 	auto start = std::chrono::high_resolution_clock::now();
 	{
-		// Initiate data copy to devices
-		workflows.resize(devices.size());
-		for (std::size_t i = 0; i < devices.size(); ++i)
-		{
-			err = queues.at(i).enqueueWriteBuffer(bufs_x.at(i),
-												  CL_FALSE,
-												  0,
-												  batch / devices.size() * N * N * sizeof(std::complex<float>),
-												  x.data() + i * batch / devices.size() * N * N,
-												  nullptr,
-												  &workflows.at(i).events.at(Workflow::Events::Write));
-			checkerr(err, "cl::CommandQueue::enqueueWriteBuffer");
-			
-			err = queues.at(i).enqueueMigrateMemObjects({ bufs_x.at(i) },
-														0,
-														nullptr,
-														//&std::vector<cl::Event>{workflows.at(i).events.at(Workflow::Events::Write)},
-														&workflows.at(i).events.at(Workflow::Events::Migrate));
-			checkerr(err, "cl::CommandQueue::enqueueMigrateBuffer");
-			
-			err = queues.at(i).flush(); checkerr(err, "cl::CommandQueue::flush");
-		}
+		Scheduler scheduler((batch + sub_batch - 1) / sub_batch, devices.size());
 
-		// Execute the plan
-		for (std::size_t i = 0; i < plans.size(); ++i)
+		workflows.resize(devices.size());
+		transforms.resize(devices.size());
+
+		// Every device is fed by a host thread of its own, claiming work until there is none left
+		//
+		// Sub-batches cycle through the ring of device buffers, each going through write -> migrate -> exec -> read.
+		// A buffer is only overwritten once the sub-batch previously occupying it has been read back, which the host
+		// waits for, so that no more than depth sub-batches are in flight. Transforms are serialized, as plans (and
+		// their intermediate buffers) are shared by all sub-batches of a device.
+		//
+		// The pipeline is never drained between claims. Throughput of a claim is measured by profiling instead, as the
+		// time between the completion of its last read and that of the previous claim.
+		auto worker = [&](std::size_t i)
 		{
-			err = cl::fft::enqueueTransform(plans.at(i),
-											CLFFT_FORWARD,
-											queues.at(i),
-											{},
-											workflows.at(i).events.at(Workflow::Events::Exec),
-											bufs_x.at(i));
-		}
-
-		// Initiate data fetch from devices
+			cl_int err = CL_SUCCESS;
+			std::size_t slot = 0;
+			std::vector<cl::Event> slot_free(depth); // Read of the last sub-batch occupying the slot
+			cl::Event last_exec;
+			std::deque<std::pair<std::size_t, cl::Event>> in_flight; // Size of claims not yet reported and their last read
+			cl::Event first_write;
+			cl_ulong last_end = 0;
+
+			// Reports claims that completed, in order
+			auto report_completed = [&]()
+			{
+				while (!in_flight.empty() && in_flight.front().second.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() == CL_COMPLETE)
+				{
+					const cl_ulong begin = last_end != 0 ? last_end : first_write.getProfilingInfo<CL_PROFILING_COMMAND_START>(),
+					               end = in_flight.front().second.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+
+					if (end > begin)
+						scheduler.report(i, in_flight.front().first, std::chrono::nanoseconds(end - begin));
+
+					last_end = std::max(last_end, end);
+					in_flight.pop_front();
+				}
+			};
+
+			for (auto claim = scheduler.claim(i); claim.second != 0; report_completed(), claim = scheduler.claim(i))
+			{
+				for (std::size_t unit = claim.first; unit < claim.first + claim.second; ++unit)
+				{
+					const std::size_t first = unit * sub_batch,
+					                  count = std::min(sub_batch, batch - first);
+					cl::Buffer& buf = bufs_x.at(i).at(slot);
+					cl::Buffer& out = hermitian ? bufs_y.at(i).at(slot) : buf;
+					cl::fft::PlanDesc unit_desc = desc;
+					unit_desc.batch = count;
+					clfftPlanHandle plan = plans.get(unit_desc, queues.at(i));
+					Workflow flow;
+
+					std::vector<cl::Event> exec_deps;
+					if (slot_free.at(slot)() != nullptr) { err = slot_free.at(slot).wait(); checkerr(err, "cl::Event::wait"); }
+					if (last_exec() != nullptr) exec_deps.push_back(last_exec);
+
+					// Initiate data copy to device
+					err = upload_queues.at(i).enqueueWriteBuffer(buf,
+																 CL_FALSE,
+																 0,
+																 count * in_bytes,
+																 in_host + first * in_bytes,
+																 nullptr,
+																 &flow.events.at(Workflow::Events::Write));
+					checkerr(err, "cl::CommandQueue::enqueueWriteBuffer");
+
+					if (first_write() == nullptr) first_write = flow.events.at(Workflow::Events::Write);
+
+					std::vector<cl::Event> migrate_deps{ flow.events.at(Workflow::Events::Write) };
+					err = queues.at(i).enqueueMigrateMemObjects({ buf },
+																0,
+																&migrate_deps,
+																&flow.events.at(Workflow::Events::Migrate));
+					checkerr(err, "cl::CommandQueue::enqueueMigrateBuffer");
+
+					// Execute the plan
+					exec_deps.push_back(flow.events.at(Workflow::Events::Migrate));
+					if (hermitian)
+						err = cl::fft::enqueueTransform(plan,
+														CLFFT_FORWARD,
+														queues.at(i),
+														exec_deps,
+														flow.events.at(Workflow::Events::Exec),
+														buf,
+														out);
+					else
+						err = cl::fft::enqueueTransform(plan,
+														CLFFT_FORWARD,
+														queues.at(i),
+														exec_deps,
+														flow.events.at(Workflow::Events::Exec),
+														buf);
+					checkerr(err, "cl::fft::enqueueTransform");
+
+					// Initiate data fetch from device
+					std::vector<cl::Event> read_deps{ flow.events.at(Workflow::Events::Exec) };
+					err = download_queues.at(i).enqueueReadBuffer(out,
+																  CL_FALSE,
+																  0,
+																  count * out_bytes,
+																  out_host + first * out_bytes,
+																  &read_deps,
+																  &flow.events.at(Workflow::Events::Read));
+					checkerr(err, "cl::CommandQueue::enqueueReadBuffer");
+
+					slot_free.at(slot) = flow.events.at(Workflow::Events::Read);
+					last_exec = flow.events.at(Workflow::Events::Exec);
+					slot = (slot + 1) % depth;
+
+					// Commands waiting on events of other queues only make progress once those are submitted
+					for (auto* stage_queues : { &upload_queues, &queues, &download_queues })
+					{
+						err = stage_queues->at(i).flush(); checkerr(err, "cl::CommandQueue::flush");
+					}
+
+					workflows.at(i).push_back(flow);
+					transforms.at(i) += count;
+				}
+
+				in_flight.emplace_back(claim.second, slot_free.at((slot + depth - 1) % depth));
+			}
+
+			// Drain the pipeline only once all work is handed out
+			err = download_queues.at(i).finish(); checkerr(err, "cl::CommandQueue::finish");
+			err = queues.at(i).finish(); checkerr(err, "cl::CommandQueue::finish");
+		};
+
+		std::vector<std::thread> threads;
 		for (std::size_t i = 0; i < devices.size(); ++i)
-		{
-			err = queues.at(i).enqueueReadBuffer(bufs_x.at(i),
-												 CL_FALSE,
-												 0,
-												 batch / devices.size() * N * N * sizeof(std::complex<float>),
-												 x.data() + i * batch / devices.size() * N * N,
-												 nullptr,
-												 &workflows.at(i).events.at(Workflow::Events::Read));
-			checkerr(err, "cl::CommandQueue::enqueueReadBuffer");
-
-			err = queues.at(i).flush(); checkerr(err, "cl::CommandQueue::flush");
-		}
+			threads.emplace_back(worker, i);
 
-		// Wait for copy to complete
-		for (auto& queue : queues)
-		{
-			err = queue.finish(); checkerr(err, "cl::CommandQueue::finish");
-		}
+		for (auto& thread : threads)
+			thread.join();
 	}
 	// End time
 	auto end = std::chrono::high_resolution_clock::now();
@@ -188,13 +362,55 @@ int main()
 	// Display timings
 	std::cout << "Total time as measured by std::chrono::high_precision_timer =\n\n\t" << std::chrono::duration_cast<std::chrono::milliseconds>(end.time_since_epoch() - start.time_since_epoch()).count() << " milliseconds.\n" << std::endl;
 
-	//report_workflow_stage<Workflow::Events::Write,   CL_PROFILING_COMMAND_SUBMIT, CL_PROFILING_COMMAND_END>("Host-device init as measured by cl::Event::getProfilingInfo", workflows);
-	report_workflow_stage<Workflow::Events::Migrate, CL_PROFILING_COMMAND_QUEUED, CL_PROFILING_COMMAND_END>("Host-device copy as measured by cl::Event::getProfilingInfo", workflows);
-	report_workflow_stage<Workflow::Events::Exec,    CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END>("Fourier transform as measured by cl::Event::getProfilingInfo", workflows);
-	report_workflow_stage<Workflow::Events::Read,    CL_PROFILING_COMMAND_SUBMIT, CL_PROFILING_COMMAND_END>("Device-host copy as measured by cl::Event::getProfilingInfo", workflows);
+	std::cout << "Transforms per device:\n\n";
+	for (std::size_t i = 0; i < devices.size(); ++i)
+		std::cout << "\t" << devices.at(i).getInfo<CL_DEVICE_NAME>() << ": " << transforms.at(i) << std::endl;
+	std::cout << std::endl;
+
+	// Busy time per device, copies overlapping transforms make these add up to more than the total time
+	report_workflow_stage<Workflow::Events::Write, CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END>("Host-device copy as measured by cl::Event::getProfilingInfo", workflows);
+	report_workflow_stage<Workflow::Events::Exec,  CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END>("Fourier transform as measured by cl::Event::getProfilingInfo", workflows);
+	report_workflow_stage<Workflow::Events::Read,  CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END>("Device-host copy as measured by cl::Event::getProfilingInfo", workflows);
+
+	// Round-trip validation: transform the Hermitian half of the first sub-batch back (C2R) and compare with the input.
+	// The backward transform is scaled by 1 / (N * N) by default, so the input should be reproduced up to rounding.
+	if (hermitian)
+	{
+		const std::size_t count = std::min(sub_batch, batch);
+		std::vector<float> round_trip(count * N * N);
+
+		cl::fft::PlanDesc back = desc;
+		back.batch = count;
+		std::swap(back.inLayout, back.outLayout);
+		std::swap(back.inStrides, back.outStrides);
+		std::swap(back.inDistance, back.outDistance);
+
+		clfftPlanHandle plan = plans.get(back, queues.at(0));
+		cl::Event exec;
+		std::vector<cl::Event> read_deps(1);
+
+		err = queues.at(0).enqueueWriteBuffer(bufs_y.at(0).at(0), CL_TRUE, 0, count * out_bytes, y.data()); checkerr(err, "cl::CommandQueue::enqueueWriteBuffer");
+		err = cl::fft::enqueueTransform(plan, CLFFT_BACKWARD, queues.at(0), {}, exec, bufs_y.at(0).at(0), bufs_x.at(0).at(0)); checkerr(err, "cl::fft::enqueueTransform");
+		read_deps.at(0) = exec;
+		err = queues.at(0).enqueueReadBuffer(bufs_x.at(0).at(0), CL_TRUE, 0, count * in_bytes, round_trip.data(), &read_deps); checkerr(err, "cl::CommandQueue::enqueueReadBuffer");
+
+		float max_error = 0;
+		for (std::size_t i = 0; i < round_trip.size(); ++i)
+			max_error = std::max(max_error, std::abs(round_trip.at(i) - xr.at(i)));
+
+		std::cout << "Round-trip (R2C -> C2R) max. abs. error over " << count << " transform(s) = " << max_error << "\n" << std::endl;
+
+		if (max_error > 1e-4f)
+		{
+			std::cerr << "Round-trip validation failed. Exiting..." << std::endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	std::cout << "Plan cache: " << plans.misses << " plan(s) baked, " << plans.hits << " request(s) served from cache.\n" << std::endl;
 
 	// Release non-RAII resources in reverse order
-	for (auto& plan : plans) err = clfftDestroyPlan(&plan);
+	plans.clear();
 	clfftTeardown();
 
 	return 0;
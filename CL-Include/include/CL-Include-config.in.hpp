@@ -1,10 +1,5 @@
 #pragma once
 
 #define CL_HPP_ENABLE_EXCEPTIONS
-#define CL_HPP_MINIMUM_OPENCL_VERSION 100
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120 // clCompileProgram and clLinkProgram
 #define CL_HPP_TARGET_OPENCL_VERSION 120
-
-// C++ Standard includes
-#include <string>
-
-static std::string kernels_path{ "${Path_KRNS}" };
@@ -5,6 +5,17 @@
 
 // C++ Standard includes
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace cl
 {
@@ -15,5 +26,132 @@ namespace cl
         {
             return std::chrono::duration_cast<Dur>(std::chrono::nanoseconds{ ev.getProfilingInfo<To>() - ev.getProfilingInfo<From>() });
         }
+
+        /// Returns the 64-bit FNV-1a hash of <c>data</c>, continuing from <c>hash</c>.
+        inline std::uint64_t fnv1a(const std::string& data, std::uint64_t hash = 14695981039346656037ull)
+        {
+            for (unsigned char c : data)
+            {
+                hash ^= c;
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+
+        /// Returns the program binary cache directory, which is <c>CL_INCLUDE_CACHE_DIR</c> if set in the environment,
+        /// otherwise cache/ next to the executable started as <c>exe</c>. Returns an empty string (no caching) if
+        /// <c>exe</c> holds no directory, as is the case when started through PATH.
+        ///
+        /// NOTE: the directory is not created, caching is skipped if it does not exist.
+        inline std::string cache_dir(const std::string& exe)
+        {
+            if (const char* dir = std::getenv("CL_INCLUDE_CACHE_DIR")) return dir;
+
+            const auto separator = exe.find_last_of("/\\");
+            return separator == std::string::npos ? std::string{} : exe.substr(0, separator) + "/cache";
+        }
+
+        /// Builds a program for <c>device</c> from <c>source</c>, reusing the binary cached in the existing directory
+        /// <c>cache_dir</c> by a previous build of the same source with the same options on the same device and driver.
+        /// <c>includes</c> holds the name and contents of every file included by <c>source</c>, which are handed to the
+        /// compiler as embedded headers. An empty <c>cache_dir</c> disables caching. Returns the program and whether it
+        /// was loaded from the cache.
+        ///
+        /// NOTE: embedded headers require clCompileProgram, hence OpenCL 1.2.
+        ///
+        /// NOTE: entries start with their full key, hash collisions and rejected binaries fall back to building
+        ///       from source.
+        inline std::pair<cl::Program, bool> build_cached(const cl::Context& context,
+                                                         const cl::Device& device,
+                                                         const std::string& source,
+                                                         const std::vector<std::pair<std::string, std::string>>& includes,
+                                                         const std::string& options,
+                                                         const std::string& cache_dir)
+        {
+            std::uint64_t source_hash = fnv1a(source);
+            for (const auto& include : includes) source_hash = fnv1a(include.second, fnv1a(include.first, source_hash));
+
+            std::stringstream key, name;
+            key << device.getInfo<CL_DEVICE_NAME>() << '\n'
+                << device.getInfo<CL_DRIVER_VERSION>() << '\n'
+                << options << '\n'
+                << std::hex << source_hash;
+            name << cache_dir << "/" << std::hex << fnv1a(key.str()) << ".bin";
+
+            const std::string path = name.str();
+
+            std::ifstream cache_file;
+            if (!cache_dir.empty()) cache_file.open(path, std::ios::binary);
+            if (cache_file.is_open())
+            {
+                std::string cached_key;
+                std::getline(cache_file, cached_key, '\0');
+
+                if (cached_key == key.str())
+                {
+                    try
+                    {
+                        cl::Program program{ context, { device }, cl::Program::Binaries{ std::vector<unsigned char>(std::istreambuf_iterator<char>{ cache_file },
+                                                                                                                    std::istreambuf_iterator<char>{}) } };
+                        program.build({ device }, options.c_str());
+
+                        return { program, true };
+                    }
+                    catch (cl::Error&) {} // Binary rejected by the runtime
+                }
+            }
+
+            // cl::Program::compile cannot take embedded headers, hence the C API
+            cl::Program program;
+            {
+                cl::Program unlinked{ context, source };
+                std::vector<cl::Program> headers;
+                std::vector<cl_program> header_ids;
+                std::vector<const char*> header_names;
+
+                for (const auto& include : includes)
+                {
+                    headers.emplace_back(context, include.second);
+                    header_ids.push_back(headers.back()());
+                    header_names.push_back(include.first.c_str());
+                }
+
+                cl_int err = clCompileProgram(unlinked(), 1, &device(), options.c_str(),
+                                              static_cast<cl_uint>(header_ids.size()), header_ids.data(), header_names.data(),
+                                              nullptr, nullptr);
+                if (err != CL_SUCCESS)
+                    throw cl::BuildError{ err, "clCompileProgram", { { device, unlinked.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) } } };
+
+                cl_program linked = clLinkProgram(context(), 1, &device(), nullptr, 1, &unlinked(), nullptr, nullptr, &err);
+                if (err != CL_SUCCESS)
+                    throw cl::Error{ err, "clLinkProgram" };
+
+                program = cl::Program{ linked };
+            }
+
+            if (cache_dir.empty()) return { program, false };
+
+            // Write a uniquely named temporary first, so concurrent runs never observe (or rename) partial entries
+            // Program may be associated with more devices of the context, binaries are listed in their order
+            const auto program_devices = program.getInfo<CL_PROGRAM_DEVICES>();
+            const auto binary = program.getInfo<CL_PROGRAM_BINARIES>().at(std::distance(program_devices.cbegin(), std::find(program_devices.cbegin(), program_devices.cend(), device)));
+            const std::string temp = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+
+            // Caching is best-effort, entries which cannot be written (eg. missing or read-only directory) are skipped
+            std::ofstream temp_file{ temp, std::ios::binary };
+            temp_file << key.str() << '\0';
+            temp_file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+            temp_file.close();
+
+            if (!temp_file.fail())
+            {
+                std::remove(path.c_str()); // std::rename need not replace existing files
+                if (std::rename(temp.c_str(), path.c_str()) == 0) return { program, false };
+            }
+            std::remove(temp.c_str());
+
+            return { program, false };
+        }
     }
 }
@@ -1,4 +1,4 @@
-#include <kernel.h.cl>
+#include "kernel.h.cl"
 
 __kernel void saxpy(real a,
                     __global real* x,
@@ -8,3 +8,40 @@ __kernel void saxpy(real a,
 	
 	y[gid] = a * x[gid] + y[gid];
 }
+
+// Vectorised variants, every work-item processes N consecutive elements. The
+// work-item owning the partial block at the end of the input (if any) falls
+// back to scalar code. vloadN/vstoreN only require scalar alignment.
+#define SAXPY_VEC(N) \
+__kernel void saxpy##N( \
+	real a, \
+	__global real* x, \
+	__global real* y, \
+	ulong length) \
+{ \
+	size_t gid = get_global_id(0), \
+	       first = gid * N; \
+\
+	if (first + N <= length) \
+		vstore##N(a * vload##N(gid, x) + vload##N(gid, y), gid, y); \
+	else \
+		for (size_t i = first ; i < length ; ++i) \
+			y[i] = a * x[i] + y[i]; \
+}
+
+SAXPY_VEC(2)
+SAXPY_VEC(4)
+SAXPY_VEC(8)
+SAXPY_VEC(16)
+
+// Grid-stride variant, launched with a fixed number of work-items independent
+// of the input length, every work-item looping over the input.
+__kernel void saxpy_grid(
+	real a,
+	__global real* x,
+	__global real* y,
+	ulong length)
+{
+	for (size_t i = get_global_id(0) ; i < length ; i += get_global_size(0))
+		y[i] = a * x[i] + y[i];
+}
@@ -1,6 +1,8 @@
 // CL-Include includes
 #include <CL-Include-config.hpp>
 #include <CL-Include.hpp>
+#include <kernel.cl.hpp>
+#include <kernel.h.cl.hpp>
 
 #include <Options.hpp>
 
@@ -14,6 +16,7 @@
 #include <chrono>
 #include <random>
 #include <sstream>
+#include <string>
 
 int main(int argc, char* argv[])
 {
@@ -52,52 +55,86 @@ int main(int argc, char* argv[])
 
         cl::CommandQueue queue{ context, device, cl::QueueProperties::Profiling };
 
-        // Load program source
-        std::ifstream source_file{ kernels_path + "/kernel.cl" };
-        if (!source_file.is_open())
-            throw std::runtime_error{ std::string{ "Cannot open kernel source: " } + (kernels_path + "/kernel.cl") };
-
-        // Create program and kernel
-        cl::Program program{ context, std::string{ std::istreambuf_iterator<char>{ source_file },
-                                                   std::istreambuf_iterator<char>{} } };
+        // Program source and the header it includes, both embedded at build time
+        const std::string source{ reinterpret_cast<const char*>(kernel_cl), kernel_cl_size },
+                          header{ reinterpret_cast<const char*>(kernel_h_cl), kernel_h_cl_size };
 
+        // Create program (reusing a cached binary if possible) and kernel
+        //
+        // NOTE: no include path is needed, the header is handed to the compiler under the name used by #include.
         std::stringstream build_opts;
-        build_opts << "-cl-std=CL1.1 "
-                   << "-I " << kernels_path;
-        program.build({ device }, build_opts.str().c_str());
+        build_opts << "-cl-std=CL1.1";
+
+        const std::string cache_path = cl::util::cache_dir(argv[0]);
+
+        auto timed_build = [&]()
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            auto result = cl::util::build_cached(context, device, source, { { "kernel.h.cl", header } }, build_opts.str(), cache_path);
+            auto finish = std::chrono::high_resolution_clock::now();
+
+            std::cout <<
+                "Program " << (result.second ? "load from cache (warm start)" : "build from source (cold start)") << " took: " <<
+                std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count() <<
+                " ms." << std::endl;
+
+            return result;
+        };
+
+        auto built = timed_build();
+        cl::Program program = built.first;
+
+        if (!built.second) timed_build(); // Report warm start as well
 
         auto saxpy = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer>(program, "saxpy");
 
         // Init computation
-        const std::size_t chainlength = std::size_t(std::pow(2u, 20u)); // 1M, cast denotes floating-to-integral conversion,
-                                                                        //     promises no data is lost, silences compiler warning
+        const std::size_t chainlength = opts.length;
         std::valarray<cl_float> vec_x(chainlength),
                                 vec_y(chainlength),
                                 ref(chainlength);
         cl_float a = 2.0;
 
-        // Fill arrays with random values between 0 and 100
+        // Fill arrays with random values between 0 and 100 (every generator made yields the same sequence)
+        auto make_prng = []()
+        {
+            return [engine = std::default_random_engine{},
+                    dist = std::uniform_real_distribution<cl_float>{ -100.0, 100.0 }]() mutable { return dist(engine); };
+        };
         {
-            auto engine = std::default_random_engine{};
-            auto dist = std::uniform_real_distribution<cl_float>{ -100.0, 100.0 };
-            auto prng = [&]() { return dist(engine); };
+            auto prng = make_prng();
 
             std::generate_n(std::begin(vec_x), chainlength, prng);
             std::generate_n(std::begin(vec_y), chainlength, prng);
         }
 
         cl::Buffer buf_x{ context, std::begin(vec_x), std::end(vec_x), true },
-                   buf_y{ context, std::begin(vec_y), std::end(vec_y), false };
+                   buf_y{ context, std::begin(vec_y), std::end(vec_y), false },
+                   buf_y_vec{ context, std::begin(vec_y), std::end(vec_y), false }, // Input of the vectorised variant
+                   buf_y_grid{ context, std::begin(vec_y), std::end(vec_y), false }; // Input of the grid-stride variant
 
         // Explicit (blocking) dispatch of data before launch
-        cl::copy(queue, std::begin(vec_x), std::end(vec_x), buf_x);
-        cl::copy(queue, std::begin(vec_y), std::end(vec_y), buf_y);
+        cl::Event upload_x_event, upload_y_event;
+        queue.enqueueWriteBuffer(buf_x, CL_TRUE, 0, chainlength * sizeof(cl_float), std::begin(vec_x), nullptr, &upload_x_event);
+        queue.enqueueWriteBuffer(buf_y, CL_TRUE, 0, chainlength * sizeof(cl_float), std::begin(vec_y), nullptr, &upload_y_event);
+        cl::copy(queue, std::begin(vec_y), std::end(vec_y), buf_y_vec);
+        cl::copy(queue, std::begin(vec_y), std::end(vec_y), buf_y_grid);
 
         // Launch kernels
         cl::Event kernel_event{ saxpy(cl::EnqueueArgs{ queue, cl::NDRange{ chainlength } }, a, buf_x, buf_y) };
 
         kernel_event.wait();
 
+        std::cout <<
+            "Host to device transfer took: " <<
+            (cl::util::get_duration<CL_PROFILING_COMMAND_START,
+                                    CL_PROFILING_COMMAND_END,
+                                    std::chrono::microseconds>(upload_x_event) +
+             cl::util::get_duration<CL_PROFILING_COMMAND_START,
+                                    CL_PROFILING_COMMAND_END,
+                                    std::chrono::microseconds>(upload_y_event)).count() <<
+            " us." << std::endl;
+
         std::cout <<
             "Device (kernel) execution took: " <<
             cl::util::get_duration<CL_PROFILING_COMMAND_START,
@@ -105,6 +142,118 @@ int main(int argc, char* argv[])
                                    std::chrono::microseconds>(kernel_event).count() <<
             " us." << std::endl;
 
+        // Launch vectorised variant matching the preferred vector width of the device (if any)
+        const cl_uint width = device.getInfo<CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT>();
+        const bool vectorised = width == 2 || width == 4 || width == 8 || width == 16;
+
+        if (vectorised)
+        {
+            auto saxpy_vec = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer, cl_ulong>(program, "saxpy" + std::to_string(width));
+
+            cl::Event vec_kernel_event{ saxpy_vec(cl::EnqueueArgs{ queue, cl::NDRange{ (chainlength + width - 1) / width } }, a, buf_x, buf_y_vec, static_cast<cl_ulong>(chainlength)) };
+
+            vec_kernel_event.wait();
+
+            std::cout <<
+                "Device (float" << width << " kernel) execution took: " <<
+                cl::util::get_duration<CL_PROFILING_COMMAND_START,
+                                       CL_PROFILING_COMMAND_END,
+                                       std::chrono::microseconds>(vec_kernel_event).count() <<
+                " us." << std::endl;
+        }
+        else
+            std::cout << "Device prefers scalar code, skipping vectorised variant." << std::endl;
+
+        // Launch grid-stride variant, enough work-groups to occupy every compute unit a few times over
+        auto saxpy_grid = cl::KernelFunctor<cl_float, cl::Buffer, cl::Buffer, cl_ulong>(program, "saxpy_grid");
+        const std::size_t grid_wgs = saxpy_grid.getKernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device),
+                          grid_size = std::min<std::size_t>(4 * device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * grid_wgs,
+                                                            (chainlength + grid_wgs - 1) / grid_wgs * grid_wgs);
+
+        cl::Event grid_kernel_event{ saxpy_grid(cl::EnqueueArgs{ queue, cl::NDRange{ grid_size }, cl::NDRange{ grid_wgs } }, a, buf_x, buf_y_grid, static_cast<cl_ulong>(chainlength)) };
+
+        grid_kernel_event.wait();
+
+        std::cout <<
+            "Device (grid-stride kernel, " << grid_size << " work-items) execution took: " <<
+            cl::util::get_duration<CL_PROFILING_COMMAND_START,
+                                   CL_PROFILING_COMMAND_END,
+                                   std::chrono::microseconds>(grid_kernel_event).count() <<
+            " us." << std::endl;
+
+        // Zero-copy variant: devices sharing memory with the host (such as CPUs) may directly access buffers allocated
+        // by the runtime in host memory. Inputs are produced directly into the mapped buffers (the same sequence as in
+        // vec_x and vec_y) and results read in place, so no transfers are needed. Both paths start from inputs in host
+        // memory and end with results readable on the host.
+        const bool unified = device.getInfo<CL_DEVICE_HOST_UNIFIED_MEMORY>() == CL_TRUE;
+        const std::size_t bytes = chainlength * sizeof(cl_float);
+
+        cl::Buffer zc_x, zc_y;
+
+        if (unified)
+        {
+            cl::Buffer copy_x{ context, CL_MEM_READ_ONLY, bytes },
+                       copy_y{ context, CL_MEM_READ_WRITE, bytes };
+            std::valarray<cl_float> copy_result(chainlength);
+
+            auto copy_path = [&]()
+            {
+                queue.enqueueWriteBuffer(copy_x, CL_TRUE, 0, bytes, std::begin(vec_x));
+                queue.enqueueWriteBuffer(copy_y, CL_TRUE, 0, bytes, std::begin(vec_y));
+                saxpy(cl::EnqueueArgs{ queue, cl::NDRange{ chainlength } }, a, copy_x, copy_y).wait();
+                queue.enqueueReadBuffer(copy_y, CL_TRUE, 0, bytes, std::begin(copy_result));
+            };
+
+            zc_x = cl::Buffer{ context, CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, bytes };
+            zc_y = cl::Buffer{ context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bytes };
+
+            // Untimed, like generating vec_x and vec_y. Repeated before every run, as SAXPY overwrites y.
+            auto produce = [&]()
+            {
+                auto x = static_cast<cl_float*>(queue.enqueueMapBuffer(zc_x, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, bytes));
+                auto y = static_cast<cl_float*>(queue.enqueueMapBuffer(zc_y, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, bytes));
+                auto prng = make_prng();
+                std::generate_n(x, chainlength, prng);
+                std::generate_n(y, chainlength, prng);
+                queue.enqueueUnmapMemObject(zc_x, x);
+                queue.enqueueUnmapMemObject(zc_y, y);
+                queue.finish();
+            };
+
+            auto zero_copy = [&]()
+            {
+                saxpy(cl::EnqueueArgs{ queue, cl::NDRange{ chainlength } }, a, zc_x, zc_y);
+
+                // Results are readable in place for as long as the mapping lives
+                auto y = static_cast<cl_float*>(queue.enqueueMapBuffer(zc_y, CL_TRUE, CL_MAP_READ, 0, bytes));
+                queue.enqueueUnmapMemObject(zc_y, y);
+                queue.finish();
+            };
+
+            // Best of a few runs, the first of which also warms up the buffers. Preparation before each run is not timed.
+            auto best_of = [](auto&& f, auto&& prepare)
+            {
+                auto best = std::chrono::high_resolution_clock::duration::max();
+                for (int i = 0; i < 5; ++i)
+                {
+                    prepare();
+                    auto start = std::chrono::high_resolution_clock::now();
+                    f();
+                    best = std::min(best, std::chrono::high_resolution_clock::now() - start);
+                }
+                return std::chrono::duration_cast<std::chrono::microseconds>(best);
+            };
+
+            const auto copy_time = best_of(copy_path, []() {}),
+                       zero_copy_time = best_of(zero_copy, produce);
+
+            std::cout <<
+                "Copy path transfer + compute took: " << copy_time.count() << " us." << std::endl <<
+                "Zero-copy (mapped host memory) transfer + compute took: " << zero_copy_time.count() << " us." << std::endl;
+        }
+        else
+            std::cout << "Device does not share memory with the host, skipping zero-copy variant." << std::endl;
+
         // Compute validation set on host
         auto start = std::chrono::high_resolution_clock::now();
 
@@ -118,7 +267,15 @@ int main(int argc, char* argv[])
             " us." << std::endl;
 
         // (Blocking) fetch of results
-        cl::copy(queue, buf_y, std::begin(vec_y), std::end(vec_y));
+        cl::Event download_event;
+        queue.enqueueReadBuffer(buf_y, CL_TRUE, 0, chainlength * sizeof(cl_float), std::begin(vec_y), nullptr, &download_event);
+
+        std::cout <<
+            "Device to host transfer took: " <<
+            cl::util::get_duration<CL_PROFILING_COMMAND_START,
+                                   CL_PROFILING_COMMAND_END,
+                                   std::chrono::microseconds>(download_event).count() <<
+            " us." << std::endl;
 
         // Validate (compute saxpy on host and match results)
         auto markers = std::mismatch(std::begin(vec_y), std::end(vec_y),
@@ -127,6 +284,29 @@ int main(int argc, char* argv[])
         if (markers.first != std::end(vec_y) ||
             markers.second != std::end(ref)) throw std::runtime_error{ "Validation failed." };
 
+        if (vectorised)
+        {
+            cl::copy(queue, buf_y_vec, std::begin(vec_y), std::end(vec_y));
+
+            if (!std::equal(std::begin(vec_y), std::end(vec_y), std::begin(ref), std::end(ref)))
+                throw std::runtime_error{ "Validation of vectorised variant failed." };
+        }
+
+        cl::copy(queue, buf_y_grid, std::begin(vec_y), std::end(vec_y));
+
+        if (!std::equal(std::begin(vec_y), std::end(vec_y), std::begin(ref), std::end(ref)))
+            throw std::runtime_error{ "Validation of grid-stride variant failed." };
+
+        if (unified)
+        {
+            auto y = static_cast<cl_float*>(queue.enqueueMapBuffer(zc_y, CL_TRUE, CL_MAP_READ, 0, bytes));
+            const bool valid = std::equal(y, y + chainlength, std::begin(ref), std::end(ref));
+            queue.enqueueUnmapMemObject(zc_y, y);
+            queue.finish();
+
+            if (!valid) throw std::runtime_error{ "Validation of zero-copy variant failed." };
+        }
+
     }
     catch (cli::error& e) // If cli parsing error occurs
     {
@@ -1,5 +1,5 @@
 // CL-Include includes
-#include <CL-Include-config.hpp>	// kernels_path
+#include <CL-Include-config.hpp>	// CL_HPP_* configuration
 #include <Options.hpp>
 
 // TCLAP includes
@@ -15,7 +15,7 @@ cli::options cli::parse(int argc, char** argv, const std::string banner)
     {
         TCLAP::CmdLine cli(banner);
 
-        TCLAP::ValueArg<std::size_t> length_arg("l", "length", "Length of input", false, 262144, "positive integral", cli);
+        TCLAP::ValueArg<std::size_t> length_arg("l", "length", "Length of input", false, 1048576, "positive integral", cli);
         TCLAP::ValueArg<std::size_t> platform_arg("p", "platform", "Index of platform to use", false, 0, "positive integral", cli );
         TCLAP::ValueArg<std::size_t> device_arg("d", "device", "Number of input points", false, 0, "positive integral", cli);
 
@@ -1,11 +1,13 @@
 #include <hip/hip_runtime.h>
 
 #include <cstddef>
+#include <cstdlib>
 #include <vector>
 #include <random>
 #include <iostream>
 #include <algorithm>
 #include <execution>
+#include <string>
 
 void checkError(hipError_t err, const char* name)
 {
@@ -17,17 +19,53 @@ void checkError(hipError_t err, const char* name)
 }
 
 __global__
-void saxpy(float a, float* x, float* y)
+void saxpy(float a, float* x, float* y, std::size_t n)
 {
     size_t tid = blockIdx.x * blockDim.x + threadIdx.x;
-    y[tid] = a * x[tid] + y[tid];
+    if (tid < n)
+        y[tid] = a * x[tid] + y[tid];
+}
+
+// Grid-stride variant, launched with a fixed number of threads independent of
+// the input length, every thread looping over the input.
+__global__
+void saxpy_grid(float a, const float* x, float* y, std::size_t n)
+{
+    for (size_t i = blockIdx.x * blockDim.x + threadIdx.x ; i < n ; i += gridDim.x * blockDim.x)
+        y[i] = a * x[i] + y[i];
+}
+
+// Every thread processes 4 consecutive elements using 16-byte loads and stores,
+// the thread owning the partial block at the end of the input (if any) falls back
+// to scalar code. Requires x and y to be 16-byte aligned, which hipMalloc ensures.
+__global__
+void saxpy4(float a, const float* x, float* y, std::size_t n)
+{
+    size_t tid = blockIdx.x * blockDim.x + threadIdx.x;
+    size_t first = tid * 4;
+
+    if (first + 4 <= n)
+    {
+        const float4 vx = reinterpret_cast<const float4*>(x)[tid];
+        float4 vy = reinterpret_cast<float4*>(y)[tid];
+
+        vy.x = a * vx.x + vy.x;
+        vy.y = a * vx.y + vy.y;
+        vy.z = a * vx.z + vy.z;
+        vy.w = a * vx.w + vy.w;
+
+        reinterpret_cast<float4*>(y)[tid] = vy;
+    }
+    else
+        for (size_t i = first ; i < n ; ++i)
+            y[i] = a * x[i] + y[i];
 }
 
 int main(int argc, char** argv)
 {
     constexpr std::size_t num_threads = 128;
-    constexpr std::size_t num_blocks = 32;
-    constexpr std::size_t N = num_threads * num_blocks;
+    const std::size_t N = argc > 2 ? std::stoull(argv[2]) : num_threads * 32;
+    const std::size_t num_blocks = (N + num_threads - 1) / num_threads;
 
     hipSetDevice(argc > 1 ? std::atoi(argv[1]) : 0);
     hipDeviceProp_t prop;
@@ -50,28 +88,93 @@ int main(int argc, char** argv)
 
     float* x_dev;
     float* y_dev;
+    float* y_vec_dev; // Input of the vectorised variant
+    float* y_grid_dev; // Input of the grid-stride variant
 
     err = hipMalloc((void**)&x_dev, sizeof(float) * N); checkError(err, "hipMalloc");
     err = hipMalloc((void**)&y_dev, sizeof(float) * N); checkError(err, "hipMalloc");
+    err = hipMalloc((void**)&y_vec_dev, sizeof(float) * N); checkError(err, "hipMalloc");
+    err = hipMalloc((void**)&y_grid_dev, sizeof(float) * N); checkError(err, "hipMalloc");
+
+    hipEvent_t upload_start, upload_end, kernel_start, kernel_end, vec_start, vec_end, grid_start, grid_end, download_start, download_end;
+    for (hipEvent_t* event : { &upload_start, &upload_end, &kernel_start, &kernel_end, &vec_start, &vec_end, &grid_start, &grid_end, &download_start, &download_end })
+    {
+        err = hipEventCreate(event); checkError(err, "hipEventCreate");
+    }
 
+    err = hipEventRecord(upload_start, 0); checkError(err, "hipEventRecord");
     err = hipMemcpy(x_dev, x.data(), x.size() * sizeof(float), hipMemcpyHostToDevice); checkError(err, "hipMemcpy");
     err = hipMemcpy(y_dev, y.data(), y.size() * sizeof(float), hipMemcpyHostToDevice); checkError(err, "hipMemcpy");
-
-    hipLaunchKernelGGL(saxpy, dim3(num_blocks), dim3(num_threads), 0, 0, a, x_dev, y_dev); checkError(hipGetLastError(), "hipKernelLaunchGGL");
-
-    std::transform(std::execution::par_unseq, x.cbegin(), x.cbegin(), y.cbegin(), x.begin(),
+    err = hipEventRecord(upload_end, 0); checkError(err, "hipEventRecord");
+    err = hipMemcpy(y_vec_dev, y.data(), y.size() * sizeof(float), hipMemcpyHostToDevice); checkError(err, "hipMemcpy");
+    err = hipMemcpy(y_grid_dev, y.data(), y.size() * sizeof(float), hipMemcpyHostToDevice); checkError(err, "hipMemcpy");
+
+    err = hipEventRecord(kernel_start, 0); checkError(err, "hipEventRecord");
+    hipLaunchKernelGGL(saxpy, dim3(num_blocks), dim3(num_threads), 0, 0, a, x_dev, y_dev, N); checkError(hipGetLastError(), "hipKernelLaunchGGL");
+    err = hipEventRecord(kernel_end, 0); checkError(err, "hipEventRecord");
+
+    // HIP has no notion of a preferred vector width, float4 matches the widest
+    // global load instruction of AMD and NVIDIA GPUs alike.
+    const std::size_t vec_blocks = ((N + 3) / 4 + num_threads - 1) / num_threads;
+    err = hipEventRecord(vec_start, 0); checkError(err, "hipEventRecord");
+    hipLaunchKernelGGL(saxpy4, dim3(vec_blocks), dim3(num_threads), 0, 0, a, x_dev, y_vec_dev, N); checkError(hipGetLastError(), "hipKernelLaunchGGL");
+    err = hipEventRecord(vec_end, 0); checkError(err, "hipEventRecord");
+
+    // Just enough blocks to fill every multiprocessor at full occupancy
+    int blocks_per_mp;
+    err = hipOccupancyMaxActiveBlocksPerMultiprocessor(&blocks_per_mp, saxpy_grid, num_threads, 0); checkError(err, "hipOccupancyMaxActiveBlocksPerMultiprocessor");
+    const std::size_t grid_blocks = std::min<std::size_t>(std::size_t(blocks_per_mp) * prop.multiProcessorCount, num_blocks);
+    err = hipEventRecord(grid_start, 0); checkError(err, "hipEventRecord");
+    hipLaunchKernelGGL(saxpy_grid, dim3(grid_blocks), dim3(num_threads), 0, 0, a, x_dev, y_grid_dev, N); checkError(hipGetLastError(), "hipKernelLaunchGGL");
+    err = hipEventRecord(grid_end, 0); checkError(err, "hipEventRecord");
+
+    std::vector<float> ref(N);
+    std::transform(std::execution::par_unseq, x.cbegin(), x.cend(), y.cbegin(), ref.begin(),
         [=](const float& x, const float& y){ return a * x + y; }
     );
 
+    // Fetch results (reuse storage of y)
+    err = hipEventRecord(download_start, 0); checkError(err, "hipEventRecord");
     err = hipMemcpy(y.data(), y_dev, y.size() * sizeof(float), hipMemcpyDeviceToHost); checkError(err, "hipMemcpy");
+    err = hipEventRecord(download_end, 0); checkError(err, "hipEventRecord");
+
+    // Same format as the OpenCL and SYCL samples, understood by SAXPY-Bench
+    float upload_ms, kernel_ms, vec_ms, grid_ms, download_ms;
+    err = hipEventSynchronize(download_end); checkError(err, "hipEventSynchronize");
+    err = hipEventElapsedTime(&upload_ms, upload_start, upload_end); checkError(err, "hipEventElapsedTime");
+    err = hipEventElapsedTime(&kernel_ms, kernel_start, kernel_end); checkError(err, "hipEventElapsedTime");
+    err = hipEventElapsedTime(&vec_ms, vec_start, vec_end); checkError(err, "hipEventElapsedTime");
+    err = hipEventElapsedTime(&grid_ms, grid_start, grid_end); checkError(err, "hipEventElapsedTime");
+    err = hipEventElapsedTime(&download_ms, download_start, download_end); checkError(err, "hipEventElapsedTime");
+    std::cout << "Host to device transfer took: " << static_cast<long long>(upload_ms * 1000) << " us." << std::endl;
+    std::cout << "Device (kernel) execution took: " << static_cast<long long>(kernel_ms * 1000) << " us." << std::endl;
+    std::cout << "Device (float4 kernel) execution took: " << static_cast<long long>(vec_ms * 1000) << " us." << std::endl;
+    std::cout << "Device (grid-stride kernel, " << grid_blocks * num_threads << " work-items) execution took: " << static_cast<long long>(grid_ms * 1000) << " us." << std::endl;
+    std::cout << "Device to host transfer took: " << static_cast<long long>(download_ms * 1000) << " us." << std::endl;
+
+    for (hipEvent_t event : { upload_start, upload_end, kernel_start, kernel_end, vec_start, vec_end, grid_start, grid_end, download_start, download_end })
+    {
+        err = hipEventDestroy(event); checkError(err, "hipEventDestroy");
+    }
+
+    // Fetch results of the other variants (reuse storage of x)
+    err = hipMemcpy(x.data(), y_vec_dev, x.size() * sizeof(float), hipMemcpyDeviceToHost); checkError(err, "hipMemcpy");
+
+    bool valid = std::equal(ref.cbegin(), ref.cend(), y.cbegin()) && std::equal(ref.cbegin(), ref.cend(), x.cbegin());
+
+    err = hipMemcpy(y.data(), y_grid_dev, y.size() * sizeof(float), hipMemcpyDeviceToHost); checkError(err, "hipMemcpy");
+
+    valid = valid && std::equal(ref.cbegin(), ref.cend(), y.cbegin());
 
-    if (std::equal(x.cbegin(), x.cend(), y.cbegin()))
+    if (!valid)
         std::cerr << "Validation failed.";
     else
         std::cout << "Validation passed.";
 
     err = hipFree(x_dev); checkError(err, "hipFree");
     err = hipFree(y_dev); checkError(err, "hipFree");
+    err = hipFree(y_vec_dev); checkError(err, "hipFree");
+    err = hipFree(y_grid_dev); checkError(err, "hipFree");
 
-    return 0;
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,223 @@
+// Benchmark includes
+#include <Options.hpp>
+
+// Standard C++ includes
+#include <algorithm>    // std::sort
+#include <cmath>        // std::ceil
+#include <cstdio>       // popen, pclose, std::fgets
+#include <cstdlib>      // EXIT_SUCCESS, EXIT_FAILURE
+#include <filesystem>   // std::filesystem::path
+#include <fstream>      // std::ofstream
+#include <iomanip>      // std::setw
+#include <iostream>     // std::cout
+#include <map>          // std::map
+#include <regex>        // std::regex
+#include <sstream>      // std::stringstream
+#include <stdexcept>    // std::runtime_error
+#include <string>       // std::string
+#include <vector>       // std::vector
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+
+namespace bench
+{
+    /// <summary>Statistics of one metric reported by a backend at a given input length.</summary>
+    ///
+    struct result
+    {
+        std::string backend, metric;
+        std::size_t length, samples;
+        double median, p99, gbps; // Times in us, gbps is zero if not applicable
+    };
+
+    /// <summary>Command line running the sample at <c>exe</c> with input of <c>length</c>.</summary>
+    /// <note>Samples are identified by their file name, as every one of them takes arguments differently.</note>
+    /// <exception cref="std::runtime_error">Thrown if the sample is not known.</exception>
+    ///
+    std::string command(const std::string& exe, std::size_t length, const cli::options& opts)
+    {
+        const std::string name = std::filesystem::path{ exe }.stem().string();
+
+        std::stringstream cmd;
+        cmd << '"' << exe << '"';
+
+        if (name == "CL-CPP-SAXPY" || name == "CL-CPP-SAXPY-SPV" || name == "CL-CPP-SAXPY-AMDGCN")
+            cmd << ' ' << opts.plat_id << ' ' << opts.dev_id << ' ' << length;
+        else if (name == "CL-Include" || name == "SYCL-SAXPY" || name == "SYCL-LazySAXPY")
+            cmd << " -p " << opts.plat_id << " -d " << opts.dev_id << " -l " << length;
+        else if (name == "HIP-SAXPY")
+            cmd << ' ' << opts.dev_id << ' ' << length;
+        else
+            throw std::runtime_error{ "Unknown SAXPY sample: " + name };
+
+        return cmd.str();
+    }
+
+    /// <summary>Runs <c>cmd</c> and collects every "<c>[metric] took: [value] [unit].</c>" line it prints.</summary>
+    /// <returns>Durations in microseconds keyed by metric.</returns>
+    /// <exception cref="std::runtime_error">Thrown if the command fails, validation failures included.</exception>
+    ///
+    std::map<std::string, double> run(const std::string& cmd)
+    {
+        FILE* pipe = popen(cmd.c_str(), "r");
+
+        if (pipe == nullptr) throw std::runtime_error{ "Failed to run: " + cmd };
+
+        std::string output;
+        char buffer[256];
+        while (std::fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        if (pclose(pipe) != 0) throw std::runtime_error{ "Failed to run: " + cmd };
+
+        static const std::regex line{ R"((.+) took: ([0-9]+(?:\.[0-9]+)?) (us|ms)\b)" };
+
+        std::map<std::string, double> metrics;
+        for (auto it = std::sregex_iterator{ output.cbegin(), output.cend(), line } ; it != std::sregex_iterator{} ; ++it)
+            metrics.emplace((*it)[1].str(), std::stod((*it)[2].str()) * ((*it)[3].str() == "ms" ? 1000. : 1.));
+
+        return metrics;
+    }
+
+    /// <summary>Median and 99th percentile (nearest rank) of <c>samples</c>.</summary>
+    /// <precondition><c>samples</c> is not empty.</precondition>
+    ///
+    std::pair<double, double> median_p99(std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+
+        const std::size_t n = samples.size();
+        const double median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        const double p99 = samples[static_cast<std::size_t>(std::ceil(0.99 * n)) - 1];
+
+        return { median, p99 };
+    }
+
+    /// <summary>Bytes moved by the operation behind <c>metric</c> with input of <c>length</c>.</summary>
+    /// <returns>Zero for metrics without a meaningful bandwidth, such as host validation or program builds.</returns>
+    ///
+    double bytes_moved(const std::string& metric, std::size_t length)
+    {
+        const double vector = static_cast<double>(length) * sizeof(float);
+
+        if (metric.rfind("Device (", 0) == 0) return 3 * vector;               // x and y read, y written
+        if (metric.rfind("Host to device transfer", 0) == 0) return 2 * vector; // x and y
+        if (metric.rfind("Device to host transfer", 0) == 0) return vector;     // y
+
+        return 0;
+    }
+
+    std::string escape(const std::string& str)
+    {
+        std::string result;
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\') result += '\\';
+            result += c;
+        }
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try // Any error results in program termination
+    {
+        const std::string banner = "SAXPY benchmark driver";
+        const cli::options opts = cli::parse(argc, argv, banner);
+
+        std::cout << banner << std::endl << std::endl;
+
+        std::vector<bench::result> results;
+
+        for (const auto& exe : opts.executables)
+            for (const auto length : opts.lengths)
+            {
+                const std::string name = std::filesystem::path{ exe }.stem().string(),
+                                  cmd = bench::command(exe, length, opts);
+
+                std::cout << "Running " << name << " with length " << length << "..." << std::endl;
+
+                // Warmup also populates program binary caches, hence later runs measure warm starts
+                for (std::size_t i = 0 ; i < opts.warmup ; ++i)
+                    bench::run(cmd);
+
+                std::map<std::string, std::vector<double>> samples;
+                for (std::size_t i = 0 ; i < opts.repetitions ; ++i)
+                    for (const auto& metric : bench::run(cmd))
+                        samples[metric.first].push_back(metric.second);
+
+                for (const auto& metric : samples)
+                {
+                    const auto stats = bench::median_p99(metric.second);
+                    const double bytes = bench::bytes_moved(metric.first, length);
+
+                    results.push_back({ name, metric.first, length, metric.second.size(),
+                                        stats.first, stats.second,
+                                        stats.first > 0 ? bytes / (stats.first * 1e3) : 0 });
+                }
+            }
+
+        std::cout << std::endl <<
+            std::left << std::setw(20) << "Backend" << std::setw(52) << "Metric" <<
+            std::right << std::setw(10) << "Length" << std::setw(12) << "Median (us)" << std::setw(12) << "p99 (us)" << std::setw(10) << "GB/s" << std::endl;
+
+        for (const auto& r : results)
+        {
+            std::cout <<
+                std::left << std::setw(20) << r.backend << std::setw(52) << r.metric <<
+                std::right << std::setw(10) << r.length << std::setw(12) << r.median << std::setw(12) << r.p99 << std::setw(10);
+            if (r.gbps > 0) std::cout << r.gbps << std::endl;
+            else std::cout << "-" << std::endl;
+        }
+
+        if (!opts.csv.empty())
+        {
+            std::ofstream csv{ opts.csv };
+
+            csv << "backend,metric,length,samples,median_us,p99_us,gbps\n";
+            for (const auto& r : results)
+            {
+                csv << r.backend << ",\"" << r.metric << "\"," << r.length << ',' << r.samples << ',' << r.median << ',' << r.p99 << ',';
+                if (r.gbps > 0) csv << r.gbps;
+                csv << '\n';
+            }
+        }
+
+        if (!opts.json.empty())
+        {
+            std::ofstream json{ opts.json };
+
+            json << "[\n";
+            for (std::size_t i = 0 ; i < results.size() ; ++i)
+            {
+                const auto& r = results[i];
+
+                json <<
+                    "  { \"backend\": \"" << bench::escape(r.backend) << "\", \"metric\": \"" << bench::escape(r.metric) << "\", " <<
+                    "\"length\": " << r.length << ", \"samples\": " << r.samples << ", " <<
+                    "\"median_us\": " << r.median << ", \"p99_us\": " << r.p99 << ", \"gbps\": ";
+                if (r.gbps > 0) json << r.gbps;
+                else json << "null";
+                json << " }" << (i + 1 != results.size() ? ",\n" : "\n");
+            }
+            json << "]\n";
+        }
+    }
+    catch (cli::error& e) // If cli parsing error occurs
+    {
+        std::cerr << e.what() << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    catch (std::exception& e) // If STL/CRT error occurs
+    {
+        std::cerr << e.what() << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
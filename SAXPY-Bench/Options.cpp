@@ -0,0 +1,52 @@
+#include <Options.hpp>
+
+// TCLAP includes
+#include <tclap/CmdLine.h>
+
+// STL includes
+#include <sstream>
+
+
+cli::options cli::parse(int argc, char** argv, const std::string banner)
+{
+    try
+    {
+        TCLAP::CmdLine cli(banner);
+
+        TCLAP::MultiArg<std::size_t> length_arg("l", "length", "Length of input, may be given multiple times to sweep lengths (default: 2^16, 2^18, 2^20, 2^22)", false, "positive integral", cli);
+        TCLAP::ValueArg<std::size_t> platform_arg("p", "platform", "Index of platform to use", false, 0, "positive integral", cli);
+        TCLAP::ValueArg<std::size_t> device_arg("d", "device", "Index of device to use", false, 0, "positive integral", cli);
+        TCLAP::ValueArg<std::size_t> warmup_arg("w", "warmup", "Number of discarded runs per length", false, 1, "positive integral", cli);
+        TCLAP::ValueArg<std::size_t> repetitions_arg("r", "repetitions", "Number of measured runs per length", false, 10, "positive integral", cli);
+        TCLAP::ValueArg<std::string> csv_arg("c", "csv", "Write results as CSV to file", false, "", "path", cli);
+        TCLAP::ValueArg<std::string> json_arg("j", "json", "Write results as JSON to file", false, "", "path", cli);
+        TCLAP::UnlabeledMultiArg<std::string> executables_arg("executables", "Sample executables to benchmark, identified by file name", true, "path", cli);
+
+        cli.parse(argc, argv);
+
+        if (repetitions_arg.getValue() == 0)
+            throw std::logic_error{ "At least one repetition is required." };
+
+        std::vector<std::size_t> lengths = length_arg.getValue();
+        if (lengths.empty())
+            lengths = { 1u << 16, 1u << 18, 1u << 20, 1u << 22 };
+
+        return { executables_arg.getValue(), lengths,
+                 platform_arg.getValue(), device_arg.getValue(),
+                 warmup_arg.getValue(), repetitions_arg.getValue(),
+                 csv_arg.getValue(), json_arg.getValue() };
+    }
+    catch (TCLAP::ArgException e)
+    {
+        std::stringstream ss;
+        ss << e.what() << std::endl;
+        ss << "error: " << e.error() << " for arg " << e.argId();
+        throw cli::error{ ss.str().c_str() };
+    }
+    catch (std::logic_error e)
+    {
+        std::stringstream ss;
+        ss << e.what();
+        throw cli::error{ e.what() };
+    }
+}
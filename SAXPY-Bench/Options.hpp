@@ -0,0 +1,38 @@
+#pragma once
+
+// STL includes
+#include <cstddef>      // std::size_t
+#include <string>       // std::string
+#include <vector>       // std::vector
+
+
+namespace cli
+{
+    struct options
+    {
+        std::vector<std::string> executables;
+        std::vector<std::size_t> lengths;
+        std::size_t plat_id, dev_id, warmup, repetitions;
+        std::string csv, json;
+    };
+
+    options parse(int argc, char** argv, const std::string banner);
+
+    class error
+    {
+    public:
+
+        error() = default;
+        error(const error&) = default;
+        error(error&&) = default;
+        ~error() = default;
+
+        error(std::string message) : m_message(message) {}
+
+        const char* what() { return m_message.c_str(); }
+
+    private:
+
+        std::string m_message;
+    };
+}
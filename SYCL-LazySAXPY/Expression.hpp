@@ -0,0 +1,248 @@
+#pragma once
+
+// SYCL include
+#include <CL/sycl.hpp>
+
+// Standard C++ includes
+#include <cstddef>      // std::size_t
+#include <type_traits>  // std::enable_if, std::is_arithmetic, std::decay
+#include <utility>      // std::declval
+#include <stdexcept>    // std::runtime_error
+
+
+/// <summary>Element-wise expressions over buffers, evaluated lazily inside a single kernel.</summary>
+/// <note>Every node has a buffer-like <c>get_access(cgh)</c> which returns an object computing its value on
+///       demand via <c>operator[]</c>, just like an accessor would read it. Evaluating an expression thus
+///       requests one accessor per leaf buffer and launches one kernel, without intermediate buffers.</note>
+/// <note>Nodes also have <c>get_access(cgh, range)</c>, limiting leaf accessors to the first <c>range</c> elements,
+///       and <c>get_count()</c>, hence they may be passed wherever a read-only buffer is consumed by index, such as
+///       the source of <c>reduce</c> in SYCL-Reduce.</note>
+///
+namespace lazy
+{
+    /// <summary>Leaf referring to a buffer.</summary>
+    ///
+    template <typename T>
+    struct terminal
+    {
+        using value_type = T;
+
+        template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
+        cl::sycl::accessor<T, 1, cl::sycl::access::mode::read, cl::sycl::access::target::global_buffer> get_access(cl::sycl::handler& cgh)
+        {
+            return buf.template get_access<cl::sycl::access::mode::read>(cgh);
+        }
+
+        template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
+        cl::sycl::accessor<T, 1, cl::sycl::access::mode::read, cl::sycl::access::target::global_buffer> get_access(cl::sycl::handler& cgh, cl::sycl::range<1> range)
+        {
+            return buf.template get_access<cl::sycl::access::mode::read>(cgh, range);
+        }
+
+        std::size_t get_count() const { return buf.get_count(); }
+
+        cl::sycl::buffer<T> buf;
+    };
+
+    /// <summary>Leaf broadcasting a value to every index. Being trivially copyable, it is its own accessor.</summary>
+    ///
+    template <typename T>
+    struct scalar
+    {
+        using value_type = T;
+
+        template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
+        scalar get_access(cl::sycl::handler&) { return *this; }
+
+        template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
+        scalar get_access(cl::sycl::handler&, cl::sycl::range<1>) { return *this; }
+
+        std::size_t get_count() const { return 0; } // Fits any length
+
+        T operator[](std::size_t) const { return value; }
+
+        T value;
+    };
+
+    template <typename Op, typename E>
+    struct unary_accessor
+    {
+        auto operator[](std::size_t i) const { return op(e[i]); }
+
+        Op op;
+        E e;
+    };
+
+    /// <summary>Node applying <c>op</c> to every element of <c>e</c>.</summary>
+    ///
+    template <typename Op, typename E>
+    struct unary
+    {
+        using value_type = decltype(std::declval<Op>()(std::declval<typename E::value_type>()));
+
+        template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
+        auto get_access(cl::sycl::handler& cgh) { return get_access<Mode, Target>(cgh, cl::sycl::range<1>{ get_count() }); }
+
+        template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
+        auto get_access(cl::sycl::handler& cgh, cl::sycl::range<1> range)
+        {
+            auto acc = e.template get_access<Mode, Target>(cgh, range);
+
+            return unary_accessor<Op, decltype(acc)>{ op, acc };
+        }
+
+        std::size_t get_count() const { return e.get_count(); }
+
+        Op op;
+        E e;
+    };
+
+    template <typename Op, typename L, typename R>
+    struct binary_accessor
+    {
+        auto operator[](std::size_t i) const { return op(l[i], r[i]); }
+
+        Op op;
+        L l;
+        R r;
+    };
+
+    /// <summary>Node combining matching elements of <c>l</c> and <c>r</c> using <c>op</c>.</summary>
+    ///
+    template <typename Op, typename L, typename R>
+    struct binary
+    {
+        using value_type = decltype(std::declval<Op>()(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()));
+
+        template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
+        auto get_access(cl::sycl::handler& cgh) { return get_access<Mode, Target>(cgh, cl::sycl::range<1>{ get_count() }); }
+
+        template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
+        auto get_access(cl::sycl::handler& cgh, cl::sycl::range<1> range)
+        {
+            auto l_acc = l.template get_access<Mode, Target>(cgh, range);
+            auto r_acc = r.template get_access<Mode, Target>(cgh, range);
+
+            return binary_accessor<Op, decltype(l_acc), decltype(r_acc)>{ op, l_acc, r_acc };
+        }
+
+        /// <precondition>Non-scalar operands are of equal length.</precondition>
+        ///
+        std::size_t get_count() const { return l.get_count() != 0 ? l.get_count() : r.get_count(); }
+
+        Op op;
+        L l;
+        R r;
+    };
+
+    template <typename T> struct is_expression : std::false_type {};
+    template <typename T> struct is_expression<terminal<T>> : std::true_type {};
+    template <typename T> struct is_expression<scalar<T>> : std::true_type {};
+    template <typename Op, typename E> struct is_expression<unary<Op, E>> : std::true_type {};
+    template <typename Op, typename L, typename R> struct is_expression<binary<Op, L, R>> : std::true_type {};
+
+    /// <summary>Creates the leaf of an expression referring to <c>buf</c>.</summary>
+    ///
+    template <typename T>
+    terminal<T> ref(cl::sycl::buffer<T> buf) { return { buf }; }
+
+    /// <summary>Lifts expressions unchanged and arithmetic values to scalar leaves, used by operators mixing the two.</summary>
+    ///
+    template <typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    E lift(E e) { return e; }
+
+    template <typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+    scalar<T> lift(T value) { return { value }; }
+
+    /// <summary>Enabled if at least one operand is an expression and the other one is an expression or arithmetic value.</summary>
+    ///
+    template <typename L, typename R>
+    using enable_if_operands = typename std::enable_if<(is_expression<L>::value || is_expression<R>::value) &&
+                                                       (is_expression<L>::value || std::is_arithmetic<L>::value) &&
+                                                       (is_expression<R>::value || std::is_arithmetic<R>::value), int>::type;
+
+    template <typename Op, typename L, typename R>
+    auto make_binary(Op op, L l, R r)
+    {
+        auto l_expr = lift(l);
+        auto r_expr = lift(r);
+
+        return binary<Op, decltype(l_expr), decltype(r_expr)>{ op, l_expr, r_expr };
+    }
+
+    namespace ops
+    {
+        struct plus { template <typename A, typename B> auto operator()(A a, B b) const { return a + b; } };
+        struct minus { template <typename A, typename B> auto operator()(A a, B b) const { return a - b; } };
+        struct multiplies { template <typename A, typename B> auto operator()(A a, B b) const { return a * b; } };
+        struct divides { template <typename A, typename B> auto operator()(A a, B b) const { return a / b; } };
+
+        struct negate { template <typename A> auto operator()(A a) const { return -a; } };
+        struct sqrt { template <typename A> auto operator()(A a) const { return cl::sycl::sqrt(a); } };
+        struct exp { template <typename A> auto operator()(A a) const { return cl::sycl::exp(a); } };
+        struct log { template <typename A> auto operator()(A a) const { return cl::sycl::log(a); } };
+        struct sin { template <typename A> auto operator()(A a) const { return cl::sycl::sin(a); } };
+        struct cos { template <typename A> auto operator()(A a) const { return cl::sycl::cos(a); } };
+        struct fabs { template <typename A> auto operator()(A a) const { return cl::sycl::fabs(a); } };
+    }
+
+    template <typename L, typename R, enable_if_operands<L, R> = 0>
+    auto operator+(L l, R r) { return make_binary(ops::plus{}, l, r); }
+
+    template <typename L, typename R, enable_if_operands<L, R> = 0>
+    auto operator-(L l, R r) { return make_binary(ops::minus{}, l, r); }
+
+    template <typename L, typename R, enable_if_operands<L, R> = 0>
+    auto operator*(L l, R r) { return make_binary(ops::multiplies{}, l, r); }
+
+    template <typename L, typename R, enable_if_operands<L, R> = 0>
+    auto operator/(L l, R r) { return make_binary(ops::divides{}, l, r); }
+
+    /// <summary>Applies <c>op</c> to every element of <c>e</c>. <c>op</c> must be callable inside kernels.</summary>
+    ///
+    template <typename E, typename Op, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    unary<Op, E> map(E e, Op op) { return { op, e }; }
+
+    template <typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    auto operator-(E e) { return map(e, ops::negate{}); }
+
+    template <typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    auto sqrt(E e) { return map(e, ops::sqrt{}); }
+
+    template <typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    auto exp(E e) { return map(e, ops::exp{}); }
+
+    template <typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    auto log(E e) { return map(e, ops::log{}); }
+
+    template <typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    auto sin(E e) { return map(e, ops::sin{}); }
+
+    template <typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    auto cos(E e) { return map(e, ops::cos{}); }
+
+    template <typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    auto fabs(E e) { return map(e, ops::fabs{}); }
+
+    /// <summary>Enqueues evaluating <c>expr</c> into <c>target</c> using a single kernel.</summary>
+    /// <note><c>target</c> may also be a leaf of <c>expr</c>, as every work-item reads only the index it writes.</note>
+    /// <exception cref="std::runtime_error">Thrown if the length of <c>expr</c> does not match that of <c>target</c>.</exception>
+    ///
+    template <typename KernelName, typename T, typename E, typename std::enable_if<is_expression<E>::value, int>::type = 0>
+    cl::sycl::event assign(cl::sycl::queue queue, cl::sycl::buffer<T> target, E expr)
+    {
+        if (expr.get_count() != target.get_count())
+            throw std::runtime_error{ "Expression length does not match the assigned buffer." };
+
+        return queue.submit([&](cl::sycl::handler& cgh)
+        {
+            auto e = expr.template get_access<cl::sycl::access::mode::read>(cgh);
+            auto dst = target.template get_access<cl::sycl::access::mode::write>(cgh);
+
+            cgh.parallel_for<KernelName>(dst.get_range(), [=](cl::sycl::item<1> i)
+            {
+                dst[i] = static_cast<T>(e[i.get_linear_id()]);
+            });
+        });
+    }
+}
@@ -1,4 +1,8 @@
 #include <Options.hpp>
+#include <Expression.hpp>
+#ifdef SYCL_LAZYSAXPY_REDUCE
+#include <Reduce.hpp>
+#endif
 
 // SYCL include
 #include <CL/sycl.hpp>
@@ -9,40 +13,10 @@
 #include <algorithm>
 #include <valarray>
 #include <random>
+#include <cmath>        // std::sqrt, std::abs
+#include <numeric>      // std::accumulate
 
 
-struct saxcessor // apologies for bad pun
-{
-    saxcessor(cl::sycl::accessor<float, 1, cl::sycl::access::mode::read, cl::sycl::access::target::constant_buffer> a,
-              cl::sycl::accessor<float, 1, cl::sycl::access::mode::read, cl::sycl::access::target::global_buffer> x)
-        : _a{a}
-        , _x{x}
-    {}
-
-    float operator[](cl::sycl::item<1> i) const { return _a[0] * _x[i]; }
-
-    cl::sycl::accessor<float, 1, cl::sycl::access::mode::read, cl::sycl::access::target::constant_buffer> _a;
-    cl::sycl::accessor<float, 1, cl::sycl::access::mode::read, cl::sycl::access::target::global_buffer> _x;
-};
-
-struct sax//py
-{
-    sax(float a, cl::sycl::buffer<float> x) : a_{cl::sycl::range<1>{1}}, x_{x}
-    {
-        a_.get_access<cl::sycl::access::mode::discard_write>()[0] = a;
-    }
-
-    template <cl::sycl::access::mode Mode, cl::sycl::access::target Target = cl::sycl::access::target::global_buffer>
-    saxcessor get_access(cl::sycl::handler& cgh)
-    {
-        return saxcessor{ a_.get_access<cl::sycl::access::mode::read, cl::sycl::access::target::constant_buffer>(cgh),
-                          x_.get_access<cl::sycl::access::mode::read>(cgh) };
-    }
-
-    cl::sycl::buffer<float> a_;
-    cl::sycl::buffer<float> x_;
-};
-
 namespace util
 {
     template <cl::sycl::info::event_profiling From,
@@ -58,7 +32,7 @@ namespace util
     }
 }
 
-namespace kernels { class saxpy; }
+namespace kernels { class saxpy; class fused; class norm; }
 
 int main(int argc, char* argv[])
 {
@@ -125,11 +99,16 @@ int main(int argc, char* argv[])
                                     cl::sycl::property_list{} };
 
         cl::sycl::buffer<float> buf_x{ cl::sycl::range<1>{opts.length} },
-                                buf_y{ cl::sycl::range<1>{opts.length} };
+                                buf_y{ cl::sycl::range<1>{opts.length} },
+                                buf_w{ cl::sycl::range<1>{opts.length} },
+                                buf_z{ cl::sycl::range<1>{opts.length} },
+                                buf_norm{ cl::sycl::range<1>{1} };
 
         std::valarray<float> arr_x(opts.length),
-                             arr_y(opts.length);
-        float a = 2.f;
+                             arr_y(opts.length),
+                             arr_w(opts.length);
+        float a = 2.f,
+              b = 3.f;
 
         // Fill arrays with random values between 0 and 100
         auto prng = [engine = std::default_random_engine{},
@@ -137,35 +116,54 @@ int main(int argc, char* argv[])
 
         std::generate_n(std::begin(arr_x), opts.length, prng);
         std::generate_n(std::begin(arr_y), opts.length, prng);
+        std::generate_n(std::begin(arr_w), opts.length, prng);
 
-        // Initialize buffer
+        // Initialize buffers (inputs of SAXPY are dispatched explicitly, so their transfer can be timed)
+        auto upload_x = queue.submit([&](cl::sycl::handler& cgh)
         {
-            auto x = buf_x.get_access<cl::sycl::access::mode::write>();
-            auto y = buf_y.get_access<cl::sycl::access::mode::write>();
+            cgh.copy(&arr_x[0], buf_x.get_access<cl::sycl::access::mode::discard_write>(cgh));
+        });
+        auto upload_y = queue.submit([&](cl::sycl::handler& cgh)
+        {
+            cgh.copy(&arr_y[0], buf_y.get_access<cl::sycl::access::mode::discard_write>(cgh));
+        });
+        {
+            auto w = buf_w.get_access<cl::sycl::access::mode::write>();
 
-            std::copy(std::begin(arr_x), std::end(arr_x), x.get_pointer());
-            std::copy(std::begin(arr_y), std::end(arr_y), y.get_pointer());
+            std::copy(std::begin(arr_w), std::end(arr_w), w.get_pointer());
         }
 
-        // Create lazy operation
-        sax buf_sax{a, buf_x};
-
-        // Compute on device
-        auto event = queue.submit([&](cl::sycl::handler& cgh)
-        {
-            auto sax = buf_sax.get_access<cl::sycl::access::mode::read>(cgh);
-            auto y = buf_y.get_access<cl::sycl::access::mode::read_write>(cgh);
+        // Create lazy operations (nothing is computed until assigned)
+        auto x = lazy::ref(buf_x),
+             y = lazy::ref(buf_y),
+             w = lazy::ref(buf_w);
 
-            cgh.parallel_for<kernels::saxpy>(y.get_range(), [=](cl::sycl::item<1> i)
-            {
-                y[i] = sax[i] + y[i];
-            });
-        });
+        // Compute on device, one kernel per assignment
+        //
+        // NOTE: z and the norm are computed first, as they read the original y.
+        lazy::assign<kernels::fused>(queue, buf_z, a * x + b * y - lazy::sqrt(lazy::fabs(w)));
+
+#ifdef SYCL_LAZYSAXPY_REDUCE
+        // Squared norm of the SAXPY result, evaluated on load by the first reduction pass (never stored)
+        reduce<kernels::norm>(queue,
+                              0.f,
+                              [](float l, float r) { return l + r; },
+                              lazy::map(a * x + y, [](float v) { return v * v; }),
+                              buf_norm);
+#endif
+        auto event = lazy::assign<kernels::saxpy>(queue, buf_y, a * x + y);
+
+        // Overlapping compute of validation set on host (once the uploads are done reading arr_y)
+        upload_x.wait_and_throw();
+        upload_y.wait_and_throw();
 
-        // Overlapping compute of validation set on host
         auto start = std::chrono::high_resolution_clock::now();
 
+        std::valarray<float> arr_z = a * arr_x + b * arr_y - std::sqrt(std::abs(arr_w));
         arr_y = a * arr_x + arr_y;
+#ifdef SYCL_LAZYSAXPY_REDUCE
+        const double norm = std::accumulate(std::begin(arr_y), std::end(arr_y), 0.0, [](double acc, float v) { return acc + double{ v } * v; });
+#endif
 
         auto finish = std::chrono::high_resolution_clock::now();
 
@@ -174,12 +172,39 @@ int main(int argc, char* argv[])
             std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() <<
             " us." << std::endl;
 
-        /*if (!opts.quiet && dev_supports_profiling) std::cout <<
+        event.wait_and_throw();
+
+        if (!opts.quiet && dev_supports_profiling) std::cout <<
+            "Host to device transfer took: " <<
+            (util::get_duration<cl::sycl::info::event_profiling::command_start,
+                                cl::sycl::info::event_profiling::command_end,
+                                std::chrono::microseconds>(upload_x) +
+             util::get_duration<cl::sycl::info::event_profiling::command_start,
+                                cl::sycl::info::event_profiling::command_end,
+                                std::chrono::microseconds>(upload_y)).count() <<
+            " us." << std::endl;
+
+        if (!opts.quiet && dev_supports_profiling) std::cout <<
             "Device (kernel) execution took: " <<
             util::get_duration<cl::sycl::info::event_profiling::command_start,
                                cl::sycl::info::event_profiling::command_end,
                                std::chrono::microseconds>(event).count() <<
-            " us." << std::endl;*/
+            " us." << std::endl;
+
+        // Explicit fetch of results (reuse storage of arr_x)
+        auto download = queue.submit([&](cl::sycl::handler& cgh)
+        {
+            cgh.copy(buf_y.get_access<cl::sycl::access::mode::read>(cgh), &arr_x[0]);
+        });
+
+        download.wait_and_throw();
+
+        if (!opts.quiet && dev_supports_profiling) std::cout <<
+            "Device to host transfer took: " <<
+            util::get_duration<cl::sycl::info::event_profiling::command_start,
+                               cl::sycl::info::event_profiling::command_end,
+                               std::chrono::microseconds>(download).count() <<
+            " us." << std::endl;
 
         // Verify
         //
@@ -193,15 +218,24 @@ int main(int argc, char* argv[])
         //             sync points, and rationale for this change, see:
         //             sycl-1.2.1.pdf: p.30, section 3.6.5.1()
         {
-            auto acc_y = buf_y.get_access<cl::sycl::access::mode::read>();
-            auto acc_y_begin = acc_y.get_pointer(),
-                 acc_y_end = acc_y.get_pointer() + acc_y.get_count();
-
             auto markers = std::mismatch(std::begin(arr_y), std::end(arr_y),
-                                         acc_y_begin, acc_y_end);
+                                         std::begin(arr_x), std::end(arr_x));
 
-            if (markers.first != std::end(arr_y) || markers.second != acc_y_end)
+            if (markers.first != std::end(arr_y) || markers.second != std::end(arr_x))
                 throw std::runtime_error{ "Validation failed." };
+
+            // Device sqrt need not be correctly rounded, hence the tolerance
+            auto acc_z = buf_z.get_access<cl::sycl::access::mode::read>();
+
+            for (std::size_t i = 0 ; i < opts.length ; ++i)
+                if (std::abs(acc_z[i] - arr_z[i]) > 1e-4f * (1.f + std::abs(arr_z[i])))
+                    throw std::runtime_error{ "Validation of fused expression failed." };
+
+#ifdef SYCL_LAZYSAXPY_REDUCE
+            // Summation order differs from the host, hence the tolerance
+            if (std::abs(buf_norm.get_access<cl::sycl::access::mode::read>()[0] - norm) > 1e-4 * norm)
+                throw std::runtime_error{ "Validation of lazy reduction failed." };
+#endif
         }
 
         if (!opts.quiet) std::cout << "Result verification passed!" << std::endl;
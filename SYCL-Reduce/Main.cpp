@@ -2,110 +2,104 @@
 #include <CL/sycl.hpp>
 
 #include "Reduce.hpp"
+#include "Scan.hpp"
+#include "TupleReduce.hpp"
 
 // Standard C++ includes
 #include <iostream>
 #include <string>
 #include <algorithm>
-#include <numeric>      // std::iota
-
-
-namespace kernels { class SYCL_Reduce; }
-
-
-/// <summary>Performs a reduction operation on the provided dataset in a non-destructive manner. Result is written to <c>result</c>.</summary>
-///
-template <typename KernelName,
-          typename ZeroElem,
-          typename F,
-          typename SourceType,
-          typename ResultType,
-          typename... Placeholders>
-auto reduce(cl::sycl::queue queue,
-            ZeroElem zero,
-            F f,
-            cl::sycl::buffer<SourceType> source,
-            cl::sycl::buffer<ResultType> result,
-            cl::sycl::range<1> work_group_size)
+#include <numeric>      // std::iota, std::partial_sum
+#include <limits>       // std::numeric_limits
+#include <cstdint>      // std::uint32_t
+#include <chrono>
+#include <vector>
+#include <tuple>
+#include <random>       // std::mt19937, std::uniform_real_distribution
+#include <cstring>      // std::memcmp
+
+
+namespace kernels
 {
-    auto device_max_wgs_for_kernel = [&]()
-    {
-        cl::sycl::program prog{ queue.get_info<cl::sycl::info::queue::context>() };
-        prog.build_with_kernel_type<KernelName>();
-        cl::sycl::kernel krn{ prog.get_kernel<KernelName>() };
-        
-        return krn.get_work_group_info<cl::sycl::info::kernel_work_group::work_group_size>(queue.get_info<cl::sycl::info::queue::device>());
-    }();
+    class SYCL_Reduce;
+#ifdef SYCL_REDUCE_SUB_GROUP
+    class SYCL_Reduce_SubGroup;
+#endif
+    class SYCL_TransformReduce;
+    class SYCL_SegmentedReduce;
+    class SYCL_Scan;
+    class SYCL_TupleReduce;
+    class SYCL_ArgMin;
+    class SYCL_ArgMax;
+    class SYCL_FastSum;
+    class SYCL_ReproducibleSum;
+}
 
-    auto reduction_step = [=](auto from,
-                              auto to,
-                              std::size_t l)
+namespace util
+{
+    /// <summary>Returns the fastest of <c>repetitions</c> invocations of <c>f</c>, each one waited upon via <c>queue</c>.</summary>
+    ///
+    template <typename Dur = std::chrono::microseconds, typename F>
+    Dur best_of(std::size_t repetitions, cl::sycl::queue queue, F f)
     {
-        queue.submit([&](cl::sycl::handler& cgh)
-        {
-            auto local = cl::sycl::accessor<SourceType, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local>{ cl::sycl::range<1>{ l }, cgh };
-            auto src = from.template get_access<cl::sycl::access::mode::read, cl::sycl::access::target::global_buffer>( cgh );
-            auto dst = to.template get_access<cl::sycl::access::mode::discard_write, cl::sycl::access::target::global_buffer>( cgh );
+        auto best = Dur::max();
 
-            cgh.parallel_for_work_group<KernelName>(cl::sycl::range<1>{ gws }, cl::sycl::range<1>{ l }, [=](cl::sycl::group<1> grp)
-            {
-                grp.async_work_group_copy(src.get_pointer() + grp.get(0) * local.get_range(0),
-                                          local.get_range().size(),
-                                          local.get_pointer()).wait();
+        for (std::size_t r = 0 ; r < repetitions ; ++r)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
 
-                grp.parallel_for_work_item([=](cl::sycl::h_item<1> i)
-                {
-                    local[i] = f(local[i], zero);
-                });
+            f();
+            queue.wait_and_throw();
 
-                for (std::size_t I = grp.get_group_range().get(0) / 2 ; I > 1 ; I /= 2) grp.parallel_for_work_item([=](cl::sycl::h_item<1> i)
-                {
-                    if (i.get_local_id().get(0) < I)
-                        local[i] = f(local[i], local[I + i]);
-                });
+            auto finish = std::chrono::high_resolution_clock::now();
 
-                grp.async_work_group_copy(local.get_pointer(),
-                                          1,
-                                          dst.get_pointer() + grp.get(0)).wait();
-            });
-        });
-    };
+            best = std::min(best, std::chrono::duration_cast<Dur>(finish - start));
+        }
 
-    if (source.get_range().size() <= work_group_size) // Single-pass reduction
-    {
-        reduction_step(source, result, work_group_size);
+        return best;
     }
-    else if (source.get_range().size() <= (work_group_size * work_group_size)) // Two-pass reduction
-    {
-        cl::sycl::buffer<SourceType> temp{ source.get_range() / work_group_size };
 
-        reduction_step(source, temp, work_group_size);
-        reduction_step(temp, result, work_group_size);
-    }
-    else // Multi-pass reduction
+    /// <summary>Sums <c>data</c> on the host using the same tree as <c>reduction::load::reproducible</c>.</summary>
+    ///
+    inline float reproducible_sum(std::vector<float> data)
     {
-        cl::sycl::buffer<SourceType> temp{ source.get_range() / work_group_size +
-                                           source.get_range() / (work_group_size * work_group_size) };
-        cl::sycl::buffer<SourceType> temp_sub1{ temp, 0, source.get_range() / work_group_size };
-        cl::sycl::buffer<SourceType> temp_sub2{ temp, (source.get_range() / work_group_size).get(0), source.get_range() / (work_group_size * work_group_size) };
+        const std::size_t wgs = impl::reduce::reproducible_wgs,
+                          tile = wgs * impl::reduce::reproducible_items;
 
-        reduction_step(source, temp_sub1, work_group_size);
-
-        for (std::size_t length = source.get_range() / work_group_size; length > work_group_size; length /= work_group_size)
+        while (true)
         {
-            reduction_step(temp_sub1,
-                           length <= work_group_size ? result : temp_sub2, // When ran for the last time, write to 'result' instead of 'temp'
-                           work_group_size,
-                           length);
-            std::swap(temp_sub1, temp_sub2);
+            std::vector<float> partials(impl::reduce::reduced_length(data.size(), tile));
+
+            for (std::size_t g = 0 ; g < partials.size() ; ++g)
+            {
+                const std::size_t first = g * tile,
+                                  last = std::min(first + tile, data.size());
+                std::vector<float> local(wgs, 0.f);
+
+                for (std::size_t l = 0 ; l < wgs ; ++l)
+                    for (std::size_t i = first + l ; i < last ; i += wgs)
+                        local[l] = local[l] + data[i];
+
+                for (std::size_t I = wgs / 2 ; I > 0 ; I /= 2)
+                    for (std::size_t l = 0 ; l < I ; ++l)
+                        local[l] = local[l] + local[l + I];
+
+                partials[g] = local[0];
+            }
+
+            if (partials.size() == 1) return partials[0];
+
+            data = std::move(partials);
         }
     }
 }
 
+
 int main()
 {
     // Sample params
-    const std::size_t length = 4096u;
+    const std::size_t length = 1000003u; // Prime, hence never a multiple of the work-group size
+    const std::size_t repetitions = 10u;
 
     try
     {
@@ -140,7 +134,7 @@ int main()
         
         cl::sycl::context ctx{ dev, async_error_handler };
 
-        cl::sycl::queue queue{ dev };
+        cl::sycl::queue queue{ ctx, dev };
 
         cl::sycl::buffer<std::uint32_t> iota_buf{ cl::sycl::range<1>{ length }, cl::sycl::property::buffer::context_bound{ ctx } };
         cl::sycl::buffer<std::uint32_t> max_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound { ctx } };
@@ -152,31 +146,271 @@ int main()
             std::iota(access.get_pointer(), access.get_pointer() + access.get_count(), 1);
         }
 
-        reduce<SYCL_Reduce>(queue,
-                            std::numeric_limits<std::uint32_t>::max(),
-                            cl::sycl::min<std::uint32_t>,
-                            iota_buf,
-                            max_buf,
-                            dev.get_info<cl::sycl::info::device::max_work_group_size>());
-
-        // Verify
-        //
-        // NOTE: host access implicitly synchronizes, meaning all operations pending on the
-        //       buffer object will complete.
-        //
-        // SYCL 1.2:   Queue DTOR is a synchronization point, but here we use host accessor as
-        //             as a sync point. (See: sycl-1.2.pdf: p.78, section 3.4.6)
-        //
-        // SYCL 1.2.1: Queue DTOR is no longer a synchronization point! (For a list of implicit
-        //             sync points, and rationale for this change, see:
-        //             sycl-1.2.1.pdf: p.30, section 3.6.5.1()
+        auto max = [](std::uint32_t a, std::uint32_t b) { return cl::sycl::max(a, b); };
+        const std::size_t wgs = dev.get_info<cl::sycl::info::device::max_work_group_size>();
+
+        auto verify = [&]()
         {
+            // NOTE: host access implicitly synchronizes, meaning all operations pending on the
+            //       buffer object will complete.
+            //
+            // SYCL 1.2:   Queue DTOR is a synchronization point, but here we use host accessor as
+            //             as a sync point. (See: sycl-1.2.pdf: p.78, section 3.4.6)
+            //
+            // SYCL 1.2.1: Queue DTOR is no longer a synchronization point! (For a list of implicit
+            //             sync points, and rationale for this change, see:
+            //             sycl-1.2.1.pdf: p.30, section 3.6.5.1()
             auto access = max_buf.get_access<cl::sycl::access::mode::read>();
 
             if (access[0] != length)
                 throw std::runtime_error{ "Wrong result computed in kernel." };
+        };
+
+        // Tree policies are compared on the CPU, falling back to the host device if there is no OpenCL CPU device
+        {
+            cl::sycl::device cpu = [&]()
+            {
+                if (dev.is_cpu()) return dev;
+
+                try { return cl::sycl::device{ cl::sycl::cpu_selector{} }; }
+                catch (cl::sycl::exception&) { return cl::sycl::device{ cl::sycl::host_selector{} }; }
+            }();
+
+            std::cout << "Comparing tree policies on " << cpu.get_info<cl::sycl::info::device::name>() << std::endl;
+
+            cl::sycl::context cpu_ctx{ cpu, async_error_handler };
+            cl::sycl::queue cpu_queue{ cpu_ctx, cpu };
+
+            cl::sycl::buffer<std::uint32_t> cpu_iota_buf{ cl::sycl::range<1>{ length }, cl::sycl::property::buffer::context_bound{ cpu_ctx } };
+            cl::sycl::buffer<std::uint32_t> cpu_max_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ cpu_ctx } };
+            {
+                auto access = cpu_iota_buf.get_access<cl::sycl::access::mode::discard_write>();
+
+                std::iota(access.get_pointer(), access.get_pointer() + access.get_count(), 1);
+            }
+
+            const std::size_t cpu_wgs = cpu.get_info<cl::sycl::info::device::max_work_group_size>();
+
+            auto cpu_verify = [&]()
+            {
+                if (cpu_max_buf.get_access<cl::sycl::access::mode::read>()[0] != length)
+                    throw std::runtime_error{ "Wrong result computed in kernel." };
+            };
+
+            // Hierarchical reduction, one barrier per tree level
+            auto hierarchical = util::best_of(repetitions, cpu_queue, [&]()
+            {
+                reduce<kernels::SYCL_Reduce, reduction::hierarchical>(cpu_queue,
+                                                                      std::numeric_limits<std::uint32_t>::min(),
+                                                                      max,
+                                                                      cpu_iota_buf,
+                                                                      cpu_max_buf,
+                                                                      cpu_wgs);
+            });
+            cpu_verify();
+
+            std::cout << "Hierarchical reduction took: " << hierarchical.count() << " us." << std::endl;
+
+#ifdef SYCL_REDUCE_SUB_GROUP
+            if (cpu.has_extension("cl_khr_subgroups") || cpu.has_extension("cl_intel_subgroups"))
+            {
+                // Sub-group reduction, no barriers once the active set fits into a sub-group
+                auto sub_group = util::best_of(repetitions, cpu_queue, [&]()
+                {
+                    reduce<kernels::SYCL_Reduce_SubGroup, reduction::sub_group>(cpu_queue,
+                                                                                std::numeric_limits<std::uint32_t>::min(),
+                                                                                max,
+                                                                                cpu_iota_buf,
+                                                                                cpu_max_buf,
+                                                                                cpu_wgs);
+                });
+                cpu_verify();
+
+                std::cout << "Sub-group reduction took: " << sub_group.count() << " us." << std::endl;
+            }
+            else
+                std::cout << "Sub-group reduction skipped, device has no sub-groups." << std::endl;
+#else
+            std::cout << "Sub-group reduction skipped, built without SYCL_REDUCE_SUB_GROUP." << std::endl;
+#endif
+        }
+
+        // Same reduction on the selected device
+        reduce<kernels::SYCL_Reduce>(queue,
+                                     std::numeric_limits<std::uint32_t>::min(),
+                                     max,
+                                     iota_buf,
+                                     max_buf,
+                                     wgs);
+        verify();
+
+        // Fused dot product, iota_buf read once per operand without an intermediate
+        cl::sycl::buffer<std::uint64_t> dot_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ ctx } };
+
+        transform_reduce<kernels::SYCL_TransformReduce>(queue,
+                                                        std::uint64_t{ 0 },
+                                                        [](std::uint64_t a, std::uint64_t b) { return a + b; },
+                                                        [](std::uint32_t x, std::uint32_t y) { return std::uint64_t{ x } * y; },
+                                                        iota_buf,
+                                                        iota_buf,
+                                                        dot_buf,
+                                                        wgs);
+        {
+            auto access = dot_buf.get_access<cl::sycl::access::mode::read>();
+
+            if (access[0] != std::uint64_t{ length } * (length + 1) * (2 * length + 1) / 6)
+                throw std::runtime_error{ "Wrong dot product computed in kernel." };
         }
 
+        // Segmented maximum over skewed segments: mostly tiny (some empty), every 100th one large
+        std::vector<std::uint32_t> offsets{ 0 };
+        for (std::uint32_t s = 0 ; offsets.back() < length ; ++s)
+            offsets.push_back(static_cast<std::uint32_t>(std::min<std::size_t>(offsets.back() + (s % 100 == 0 ? 50000u : s % 7), length)));
+
+        cl::sycl::buffer<std::uint32_t> offsets_buf{ offsets.cbegin(), offsets.cend(), cl::sycl::property::buffer::context_bound{ ctx } };
+        cl::sycl::buffer<std::uint32_t> segment_max_buf{ cl::sycl::range<1>{ offsets.size() - 1 }, cl::sycl::property::buffer::context_bound{ ctx } };
+
+        auto segmented = util::best_of(repetitions, queue, [&]()
+        {
+            segmented_reduce<kernels::SYCL_SegmentedReduce>(queue,
+                                                            std::numeric_limits<std::uint32_t>::min(),
+                                                            max,
+                                                            iota_buf,
+                                                            offsets_buf,
+                                                            segment_max_buf,
+                                                            wgs);
+        });
+        {
+            auto access = segment_max_buf.get_access<cl::sycl::access::mode::read>();
+
+            // iota_buf[i] == i + 1, hence the maximum of a non-empty segment is its end offset
+            for (std::size_t s = 0 ; s < offsets.size() - 1 ; ++s)
+                if (access[s] != (offsets[s] == offsets[s + 1] ? 0u : offsets[s + 1]))
+                    throw std::runtime_error{ "Wrong segmented result computed in kernel." };
+        }
+
+        std::cout << "Segmented reduction of " << offsets.size() - 1 << " segments took: " << segmented.count() << " us." << std::endl;
+
+        // Prefix sums (wrapping around, like the host reference)
+        cl::sycl::buffer<std::uint32_t> scan_buf{ cl::sycl::range<1>{ length }, cl::sycl::property::buffer::context_bound{ ctx } };
+        auto plus = [](std::uint32_t a, std::uint32_t b) { return a + b; };
+
+        std::vector<std::uint32_t> ref(length);
+        std::iota(ref.begin(), ref.end(), 1);
+        std::partial_sum(ref.begin(), ref.end(), ref.begin());
+
+        auto gbps = [&](std::chrono::microseconds dur) // Every element is read and written once
+        {
+            return 2. * length * sizeof(std::uint32_t) / std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count();
+        };
+
+        auto inclusive = util::best_of(repetitions, queue, [&]()
+        {
+            inclusive_scan<kernels::SYCL_Scan>(queue, std::uint32_t{ 0 }, plus, iota_buf, scan_buf, wgs);
+        });
+        {
+            auto access = scan_buf.get_access<cl::sycl::access::mode::read>();
+
+            if (!std::equal(ref.cbegin(), ref.cend(), access.get_pointer()))
+                throw std::runtime_error{ "Wrong inclusive scan computed in kernel." };
+        }
+
+        auto exclusive = util::best_of(repetitions, queue, [&]()
+        {
+            exclusive_scan<kernels::SYCL_Scan>(queue, std::uint32_t{ 0 }, plus, iota_buf, scan_buf, wgs);
+        });
+        {
+            auto access = scan_buf.get_access<cl::sycl::access::mode::read>();
+
+            if (access[0] != 0u || !std::equal(ref.cbegin(), ref.cend() - 1, access.get_pointer() + 1))
+                throw std::runtime_error{ "Wrong exclusive scan computed in kernel." };
+        }
+
+        // Statistics pass: minimum, maximum, sum and count reading iota_buf once
+        cl::sycl::buffer<std::uint32_t> stat_min_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ ctx } },
+                                        stat_max_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ ctx } };
+        cl::sycl::buffer<std::uint64_t> stat_sum_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ ctx } },
+                                        stat_count_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ ctx } };
+        auto plus64 = [](std::uint64_t a, std::uint64_t b) { return a + b; };
+
+        auto stats = util::best_of(repetitions, queue, [&]()
+        {
+            reduce_tuple<kernels::SYCL_TupleReduce>(queue,
+                                                    std::make_tuple(reduction::make_op(std::numeric_limits<std::uint32_t>::max(), [](std::uint32_t a, std::uint32_t b) { return cl::sycl::min(a, b); }),
+                                                                    reduction::make_op(std::numeric_limits<std::uint32_t>::min(), max),
+                                                                    reduction::make_op(std::uint64_t{ 0 }, plus64, [](std::uint32_t x) { return std::uint64_t{ x }; }),
+                                                                    reduction::make_op(std::uint64_t{ 0 }, plus64, [](std::uint32_t) { return std::uint64_t{ 1 }; })),
+                                                    iota_buf,
+                                                    std::make_tuple(stat_min_buf, stat_max_buf, stat_sum_buf, stat_count_buf),
+                                                    wgs);
+        });
+        {
+            if (stat_min_buf.get_access<cl::sycl::access::mode::read>()[0] != 1u ||
+                stat_max_buf.get_access<cl::sycl::access::mode::read>()[0] != length ||
+                stat_sum_buf.get_access<cl::sycl::access::mode::read>()[0] != std::uint64_t{ length } * (length + 1) / 2 ||
+                stat_count_buf.get_access<cl::sycl::access::mode::read>()[0] != length)
+                throw std::runtime_error{ "Wrong statistics computed in kernel." };
+        }
+
+        // Locating extrema of a sawtooth, every value occurs multiple times
+        cl::sycl::buffer<std::uint32_t> saw_buf{ cl::sycl::range<1>{ length }, cl::sycl::property::buffer::context_bound{ ctx } };
+        cl::sycl::buffer<reduction::indexed<std::uint32_t>> arg_min_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ ctx } },
+                                                            arg_max_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ ctx } };
+        {
+            auto access = saw_buf.get_access<cl::sycl::access::mode::discard_write>();
+
+            for (std::size_t i = 0 ; i < length ; ++i) access[i] = static_cast<std::uint32_t>(i % 1000u);
+        }
+
+        arg_min<kernels::SYCL_ArgMin>(queue, saw_buf, arg_min_buf, wgs);
+        arg_max<kernels::SYCL_ArgMax>(queue, saw_buf, arg_max_buf, wgs);
+        {
+            auto lo = arg_min_buf.get_access<cl::sycl::access::mode::read>()[0];
+            auto hi = arg_max_buf.get_access<cl::sycl::access::mode::read>()[0];
+
+            if (lo.value != 0u || lo.index != 0u || hi.value != 999u || hi.index != 999u)
+                throw std::runtime_error{ "Wrong extremum location computed in kernel." };
+        }
+
+        // Floating-point sum, fast versus bit-reproducible
+        std::vector<float> floats(length);
+        {
+            std::mt19937 prng{ 42u };
+            std::uniform_real_distribution<float> dist{ -1.f, 1.f };
+
+            std::generate(floats.begin(), floats.end(), [&]() { return dist(prng); });
+        }
+
+        cl::sycl::buffer<float> float_buf{ floats.cbegin(), floats.cend(), cl::sycl::property::buffer::context_bound{ ctx } };
+        cl::sycl::buffer<float> float_sum_buf{ cl::sycl::range<1>{ 1 }, cl::sycl::property::buffer::context_bound{ ctx } };
+        auto plusf = [](float a, float b) { return a + b; };
+
+        auto fast_sum = util::best_of(repetitions, queue, [&]()
+        {
+            reduce<kernels::SYCL_FastSum>(queue, 0.f, plusf, float_buf, float_sum_buf, wgs, reduction::load::grid_stride);
+        });
+        const float fast = float_sum_buf.get_access<cl::sycl::access::mode::read>()[0];
+
+        auto reproducible_sum = util::best_of(repetitions, queue, [&]()
+        {
+            reduce<kernels::SYCL_ReproducibleSum>(queue, 0.f, plusf, float_buf, float_sum_buf, wgs, reduction::load::reproducible);
+        });
+        {
+            const float device = float_sum_buf.get_access<cl::sycl::access::mode::read>()[0],
+                        host = util::reproducible_sum(floats);
+
+            if (std::memcmp(&device, &host, sizeof(float)) != 0)
+                throw std::runtime_error{ "Reproducible sum differs from host reference." };
+
+            std::cout << "Fast float sum (" << fast << ") took: " << fast_sum.count() << " us." << std::endl;
+            std::cout << "Reproducible float sum (" << device << ") took: " << reproducible_sum.count() << " us. (" <<
+                static_cast<double>(reproducible_sum.count()) / fast_sum.count() << "x)" << std::endl;
+        }
+
+        std::cout << "Statistics (min, max, sum, count) took: " << stats.count() << " us." << std::endl;
+        std::cout << "Inclusive scan took: " << inclusive.count() << " us. (" << gbps(inclusive) << " GB/s)" << std::endl;
+        std::cout << "Exclusive scan took: " << exclusive.count() << " us. (" << gbps(exclusive) << " GB/s)" << std::endl;
+
         std::cout << "Result verification passed!" << std::endl;
     }
     catch (cl::sycl::exception e)
@@ -1,70 +1,798 @@
+#pragma once
+
 // SYCL include
 #include <CL/sycl.hpp>
 
+// Standard C++ includes
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint32_t
+#include <algorithm>    // std::min, std::max, std::find_if
+#include <limits>       // std::numeric_limits
+#include <utility>      // std::swap
+#include <vector>       // std::vector
+#include <mutex>        // std::mutex, std::lock_guard
+#include <stdexcept>    // std::runtime_error
+
+
+namespace reduction
+{
+    /// <summary>Selects how much input every work-group of a reduction pass folds.</summary>
+    ///
+    enum class load
+    {
+        element_per_item,   // One work-item per input element, one partial result per work-group worth of input
+        grid_stride,        // Work-groups capped by the compute-unit count, work-items fold a strided chunk first
+        reproducible        // Fixed work-group size and tile, the result is bit-identical on every device
+    };
+
+    /// <summary>Tree policy issuing a work-group barrier per level, using hierarchical <c>parallel_for_work_group</c>.</summary>
+    ///
+    struct hierarchical {};
+
+#ifdef SYCL_REDUCE_SUB_GROUP
+    /// <summary>Tree policy issuing work-group barriers only until the active set fits into a single sub-group,
+    ///          finishing the last log2(sub-group size) levels with sub-group shuffles.</summary>
+    /// <note>Sub-groups are an extension to SYCL 1.2.1, hence the policy is only available if <c>SYCL_REDUCE_SUB_GROUP</c>
+    ///       is defined. Devices must expose sub-groups too, eg. via <c>cl_khr_subgroups</c> or <c>cl_intel_subgroups</c>.</note>
+    /// <precondition>Sub-group size of the device is a power of two.</precondition>
+    ///
+    struct sub_group {};
+#endif
+
+    /// <summary>Value of an element along with its position in the source, result type of <c>arg_min</c> and <c>arg_max</c>.</summary>
+    ///
+    template <typename T>
+    struct indexed
+    {
+        T value;
+        std::uint64_t index;
+    };
+}
+
 namespace impl
 {
     namespace reduce
     {
+        /// <summary>Work-group limit of a kernel on one device of one context.</summary>
+        ///
+        struct kernel_limits
+        {
+            cl::sycl::context context;
+            cl::sycl::device device;
+            std::size_t max_wgs;
+        };
+
+        /// <summary>Returns the limits of the kernel named <c>KernelName</c> built for the context and device of <c>queue</c>.</summary>
+        /// <note>Querying limits requires building a program, which is expensive, hence results are cached process-wide and
+        ///       shared between threads. One cache exists per kernel type, holding an entry per (context, device) pair, of
+        ///       which there are only a few.</note>
+        /// <note>Only the limits are cached, kernels are still submitted by type and built by the SYCL runtime.</note>
+        ///
         template <typename KernelName>
-        std::size_t device_max_wgs_for_kernel(cl::sycl::queue queue)
+        kernel_limits cached_kernel_limits(cl::sycl::queue queue)
         {
-            cl::sycl::program prog{ queue.get_info<cl::sycl::info::queue::context>() };
+            static std::mutex mutex;
+            static std::vector<kernel_limits> cache;
+
+            auto ctx = queue.get_info<cl::sycl::info::queue::context>();
+            auto dev = queue.get_info<cl::sycl::info::queue::device>();
+
+            std::lock_guard<std::mutex> lock{ mutex };
+
+            auto it = std::find_if(cache.cbegin(), cache.cend(), [&](const kernel_limits& limits)
+            {
+                return limits.context == ctx && limits.device == dev;
+            });
+
+            if (it != cache.cend()) return *it;
+
+            cl::sycl::program prog{ ctx };
             prog.build_with_kernel_type<KernelName>();
             cl::sycl::kernel krn{ prog.get_kernel<KernelName>() };
 
-            return krn.get_work_group_info<cl::sycl::info::kernel_work_group::work_group_size>(queue.get_info<cl::sycl::info::queue::device>());
+            cache.push_back(kernel_limits{ ctx, dev, krn.get_work_group_info<cl::sycl::info::kernel_work_group::work_group_size>(dev) });
+
+            return cache.back();
         }
 
-        template <typename F, typename T, typename P>
-        void in_place_reduce(cl::sycl::h_item<1> i,
-                             P first,
-                             P last,
-                             P to,
-                             T init,
-                             F f)
+        template <typename KernelName>
+        std::size_t device_max_wgs_for_kernel(cl::sycl::queue queue)
         {
+            return cached_kernel_limits<KernelName>(queue).max_wgs;
+        }
+
+        /// <summary>Returns the largest power of two not greater than <c>n</c>.</summary>
+        ///
+        inline std::size_t prev_pow2(std::size_t n)
+        {
+            std::size_t result = 1;
+
+            while (result <= n / 2) result *= 2;
+
+            return result;
+        }
+
+        /// <summary>Returns the least common multiple of <c>a</c> and <c>b</c>.</summary>
+        ///
+        inline std::size_t lcm(std::size_t a, std::size_t b)
+        {
+            std::size_t x = a, y = b;
+
+            while (y != 0) { std::size_t r = x % y; x = y; y = r; }
+
+            return a / x * b;
+        }
 
+        /// <summary>Returns the number of partial results left after one pass over <c>length</c> elements with work-groups of size <c>wgs</c>.</summary>
+        ///
+        inline std::size_t reduced_length(std::size_t length, std::size_t wgs)
+        {
+            return (length + wgs - 1) / wgs;
+        }
+
+        /// <summary>Folds the elements of <c>src</c> at <c>first</c>, <c>first + stride</c>, ... below <c>length</c> into <c>init</c>.</summary>
+        ///
+        template <typename Accessor, typename T, typename F>
+        T strided_fold(Accessor src,
+                       std::size_t first,
+                       std::size_t length,
+                       std::size_t stride,
+                       T init,
+                       F f)
+        {
+            for (std::size_t i = first ; i < length ; i += stride)
+                init = f(init, src[i]);
+
+            return init;
         }
 
-        /// <summary>Performs parallel reduction on the range [<c>from</c>;<c>to</c>) using the binary operator <c>F</c>.</summary>
-        /// <precondition><c>local % grp.get_group_range().get(0) == 0</c></precondition>
+        /// <summary>Performs parallel reduction of <c>local</c> using the binary operator <c>f</c>. Result is left in <c>local[0]</c>.</summary>
+        /// <precondition><c>grp.get_local_range().get(0)</c> is a power of two and equals <c>local.get_range().get(0)</c></precondition>
         ///
         template <typename F, typename T>
         void in_place_reduce(cl::sycl::group<1> grp,
-                             cl::sycl::local_ptr<T> first,
-                             cl::sycl::local_ptr<T> last,
-                             cl::sycl::local_ptr<T> to,
-                             T init,
+                             cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local> local,
                              F f)
         {
-            auto range = [=](std::size_t i) -> typename cl::sycl::local_ptr<T>::reference_t { return i < last - first ? first[i] : init; };
+            for (std::size_t I = grp.get_local_range().get(0) / 2 ; I > 0 ; I /= 2) grp.parallel_for_work_item([=](cl::sycl::h_item<1> i)
+            {
+                if (i.get_local_id(0) < I)
+                    local[i.get_local_id()] = f(local[i.get_local_id()], local[i.get_local_id(0) + I]);
+            });
+        }
 
-            for (; last != first + grp.get_group_range().get(0) ; last -= grp.get_group_range().get(0))
+        /// <summary>ND-range counterpart of the hierarchical overload, to be called by every work-item of the work-group.</summary>
+        /// <precondition><c>item.get_local_range().get(0)</c> is a power of two and equals <c>local.get_range().get(0)</c></precondition>
+        ///
+        template <typename F, typename T>
+        void in_place_reduce(cl::sycl::nd_item<1> item,
+                             cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local> local,
+                             F f)
+        {
+            const std::size_t lid = item.get_local_id(0);
+
+            for (std::size_t I = item.get_local_range().get(0) / 2 ; I > 0 ; I /= 2)
             {
-                grp.parallel_for_work_item([=](cl::sycl::h_item<1> i)
-                {
-                        range(i.get_local_id()) = f(range(i.get_local_id()), first[i.get_local_id()]);
-                }
+                item.barrier(cl::sycl::access::fence_space::local_space);
+
+                if (lid < I)
+                    local[lid] = f(local[lid], local[lid + I]);
+            }
+
+            item.barrier(cl::sycl::access::fence_space::local_space);
+        }
+
+        /// <summary>Returns the index of the last element in the sorted range [<c>first</c>;<c>first + count</c>) of
+        ///          <c>acc</c> not greater than <c>value</c>.</summary>
+        /// <precondition><c>acc[first] <= value</c></precondition>
+        ///
+        template <typename Accessor>
+        std::size_t last_not_greater(Accessor acc,
+                                     std::size_t first,
+                                     std::size_t count,
+                                     std::size_t value)
+        {
+            while (count > 1)
+            {
+                const std::size_t half = count / 2;
+
+                if (static_cast<std::size_t>(acc[first + half]) <= value)
+                    first += half;
+
+                count -= half;
             }
 
-            for (auto I = grp.get_group_range().get(0) / 2; I > 1; I /= 2) grp.parallel_for_work_item([=](cl::sycl::h_item<1> i)
+            return first;
+        }
+
+        /// <summary>Enqueues one reduction pass, folding every <c>tile</c> of the first <c>length</c> elements of <c>from</c>
+        ///          into one partial result, written to the front of <c>to</c>.</summary>
+        /// <note><c>Source</c> is either a buffer or any type with a buffer-like <c>get_access(cgh, range)</c> returning
+        ///       an indexable object, such as <c>unary_transform_buffer</c>.</note>
+        /// <note>Every work-item folds the elements of its tile at a stride of <c>wgs</c> into a private accumulator
+        ///       before the tree phase. Work-items without input keep <c>zero</c>, hence it must be the identity of <c>f</c>.</note>
+        /// <precondition><c>tile</c> is a multiple of <c>wgs</c></precondition>
+        ///
+        template <typename KernelName, typename Source, typename T, typename F>
+        cl::sycl::event in_place_reduce(reduction::hierarchical,
+                                        cl::sycl::queue queue,
+                                        Source from,
+                                        cl::sycl::buffer<T> to,
+                                        std::size_t length,
+                                        std::size_t tile,
+                                        std::size_t wgs,
+                                        T zero,
+                                        F f)
+        {
+            const std::size_t groups = reduced_length(length, tile);
+
+            return queue.submit([&](cl::sycl::handler& cgh)
             {
-                if (i.get_local_id().get(0) < I)
-                    local[i] = f(local[i], local[I + i]);
+                auto local = cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local>{ cl::sycl::range<1>{ wgs }, cgh };
+                auto src = from.template get_access<cl::sycl::access::mode::read>(cgh, cl::sycl::range<1>{ length });
+                auto dst = to.template get_access<cl::sycl::access::mode::discard_write>(cgh, cl::sycl::range<1>{ groups });
+
+                cgh.parallel_for_work_group<KernelName>(cl::sycl::range<1>{ groups }, cl::sycl::range<1>{ wgs }, [=](cl::sycl::group<1> grp)
+                {
+                    const std::size_t first = grp.get_id(0) * tile,
+                                      last = first + tile < length ? first + tile : length;
+
+                    grp.parallel_for_work_item([=](cl::sycl::h_item<1> i)
+                    {
+                        local[i.get_local_id()] = strided_fold(src, first + i.get_local_id(0), last, wgs, zero, f);
+                    });
+
+                    in_place_reduce(grp, local, f);
+
+                    dst[grp.get_id(0)] = local[0];
+                });
             });
+        }
 
-            *to = local[0];
+#ifdef SYCL_REDUCE_SUB_GROUP
+        /// <summary>Same as the hierarchical overload, but uses an ND-range kernel so the last tree levels may
+        ///          be carried out by the first sub-group of every work-group without barriers.</summary>
+        ///
+        template <typename KernelName, typename Source, typename T, typename F>
+        cl::sycl::event in_place_reduce(reduction::sub_group,
+                                        cl::sycl::queue queue,
+                                        Source from,
+                                        cl::sycl::buffer<T> to,
+                                        std::size_t length,
+                                        std::size_t tile,
+                                        std::size_t wgs,
+                                        T zero,
+                                        F f)
+        {
+            const std::size_t groups = reduced_length(length, tile);
+
+            return queue.submit([&](cl::sycl::handler& cgh)
+            {
+                auto local = cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local>{ cl::sycl::range<1>{ wgs }, cgh };
+                auto src = from.template get_access<cl::sycl::access::mode::read>(cgh, cl::sycl::range<1>{ length });
+                auto dst = to.template get_access<cl::sycl::access::mode::discard_write>(cgh, cl::sycl::range<1>{ groups });
+
+                cgh.parallel_for<KernelName>(cl::sycl::nd_range<1>{ cl::sycl::range<1>{ groups * wgs }, cl::sycl::range<1>{ wgs } }, [=](cl::sycl::nd_item<1> item)
+                {
+                    const std::size_t lid = item.get_local_id(0),
+                                      first = item.get_group(0) * tile,
+                                      last = first + tile < length ? first + tile : length;
+                    auto sg = item.get_sub_group();
+                    const std::size_t sgs = sg.get_local_range().get(0);
+
+                    local[lid] = strided_fold(src, first + lid, last, wgs, zero, f);
+
+                    for (std::size_t I = wgs / 2 ; I >= sgs ; I /= 2)
+                    {
+                        item.barrier(cl::sycl::access::fence_space::local_space);
+
+                        if (lid < I)
+                            local[lid] = f(local[lid], local[lid + I]);
+                    }
+
+                    item.barrier(cl::sycl::access::fence_space::local_space);
+
+                    if (lid < sgs) // First sub-group only
+                    {
+                        T acc = local[lid];
+
+                        for (std::size_t I = sgs / 2 ; I > 0 ; I /= 2)
+                            acc = f(acc, sg.shuffle_down(acc, static_cast<std::uint32_t>(I)));
+
+                        if (lid == 0)
+                            dst[item.get_group(0)] = acc;
+                    }
+                });
+            });
         }
+#endif
 
-        template <typename F, typename T>
-        void in_place_reduce(cl::sycl::queue queue,
-                             cl::sycl::global_ptr<T> first,
-                             cl::sycl::global_ptr<T> last,
-                             cl::sycl::global_ptr<T> to,
-                             T init,
-                             F f)
+        /// <summary>Accessor-like view applying <c>op</c> to the elements of <c>x</c> on load.</summary>
+        ///
+        template <typename Accessor, typename UnaryOp>
+        struct unary_transform_accessor
+        {
+            auto operator[](std::size_t i) const { return op(x[i]); }
+
+            Accessor x;
+            UnaryOp op;
+        };
+
+        /// <summary>Accessor-like view applying <c>op</c> to the elements of <c>x</c> and <c>y</c> pairwise on load.</summary>
+        ///
+        template <typename Accessor1, typename Accessor2, typename BinaryOp>
+        struct binary_transform_accessor
+        {
+            auto operator[](std::size_t i) const { return op(x[i], y[i]); }
+
+            Accessor1 x;
+            Accessor2 y;
+            BinaryOp op;
+        };
+
+        /// <summary>Buffer-like reduction source yielding <c>op(x[i])</c> without materializing it.</summary>
+        ///
+        template <typename U, typename UnaryOp>
+        struct unary_transform_buffer
+        {
+            template <cl::sycl::access::mode Mode>
+            auto get_access(cl::sycl::handler& cgh, cl::sycl::range<1> range)
+            {
+                auto acc_x = x.template get_access<Mode>(cgh, range);
+
+                return unary_transform_accessor<decltype(acc_x), UnaryOp>{ acc_x, op };
+            }
+
+            cl::sycl::buffer<U> x;
+            UnaryOp op;
+        };
+
+        /// <summary>Buffer-like reduction source yielding <c>op(x[i], y[i])</c> without materializing it.</summary>
+        ///
+        template <typename U1, typename U2, typename BinaryOp>
+        struct binary_transform_buffer
+        {
+            template <cl::sycl::access::mode Mode>
+            auto get_access(cl::sycl::handler& cgh, cl::sycl::range<1> range)
+            {
+                auto acc_x = x.template get_access<Mode>(cgh, range);
+                auto acc_y = y.template get_access<Mode>(cgh, range);
+
+                return binary_transform_accessor<decltype(acc_x), decltype(acc_y), BinaryOp>{ acc_x, acc_y, op };
+            }
+
+            cl::sycl::buffer<U1> x;
+            cl::sycl::buffer<U2> y;
+            BinaryOp op;
+        };
+
+        /// <summary>Kernel name of the first pass of a reduction, if it reads a different source type than the rest.</summary>
+        ///
+        template <typename KernelName> class first_pass;
+
+        /// <summary>Accessor-like view yielding elements of <c>x</c> paired with their index.</summary>
+        ///
+        template <typename Accessor, typename T>
+        struct indexing_accessor
+        {
+            reduction::indexed<T> operator[](std::size_t i) const { return { x[i], i }; }
+
+            Accessor x;
+        };
+
+        /// <summary>Buffer-like reduction source yielding <c>{ x[i], i }</c> without materializing indices.</summary>
+        ///
+        template <typename T>
+        struct indexing_buffer
+        {
+            template <cl::sycl::access::mode Mode>
+            auto get_access(cl::sycl::handler& cgh, cl::sycl::range<1> range)
+            {
+                auto acc_x = x.template get_access<Mode>(cgh, range);
+
+                return indexing_accessor<decltype(acc_x), T>{ acc_x };
+            }
+
+            cl::sycl::buffer<T> x;
+        };
+
+        /// <summary>Selects the smaller (or with <c>Max</c> the larger) of two indexed values, the lower index on ties.</summary>
+        /// <note>Ties are resolved independently of operand order, hence the result does not depend on the shape
+        ///       of the reduction tree.</note>
+        ///
+        template <bool Max>
+        struct arg_select
         {
-            queue.submit([&]())
+            template <typename T>
+            reduction::indexed<T> operator()(reduction::indexed<T> a, reduction::indexed<T> b) const
+            {
+                const bool a_wins = Max ? b.value < a.value : a.value < b.value,
+                           tie = !(a.value < b.value) && !(b.value < a.value);
+
+                return a_wins || (tie && a.index < b.index) ? a : b;
+            }
+        };
+
+        /// <summary>Work-group size and per work-item share of a tile in <c>reduction::load::reproducible</c> mode.</summary>
+        /// <note>Small enough for every device to launch, large enough to keep the pass count low.</note>
+        ///
+        constexpr std::size_t reproducible_wgs = 64,
+                              reproducible_items = 16;
+
+        /// <summary>Kernel name of the pass combining per-tile partial results of a segmented reduction.</summary>
+        ///
+        template <typename KernelName> class segment_fixup;
+
+        /// <summary>Performs parallel reduction of <c>source</c> into <c>result[0]</c>.</summary>
+        /// <note>The first pass reads <c>source</c> using kernel <c>FirstKernelName</c>, the remaining passes
+        ///       read temporaries of type <c>T</c> using kernel <c>KernelName</c>.</note>
+        ///
+        template <typename KernelName,
+                  typename FirstKernelName,
+                  typename Policy,
+                  typename Source,
+                  typename T,
+                  typename F>
+        cl::sycl::event multi_pass_reduce(cl::sycl::queue queue,
+                                          T zero,
+                                          F f,
+                                          Source source,
+                                          std::size_t length,
+                                          cl::sycl::buffer<T> result,
+                                          std::size_t work_group_size,
+                                          reduction::load load)
+        {
+            // Nothing to reduce, the result is the identity
+            if (length == 0)
+                return queue.submit([&](cl::sycl::handler& cgh)
+                {
+                    cgh.fill(result.template get_access<cl::sycl::access::mode::discard_write>(cgh, cl::sycl::range<1>{ 1 }), zero);
+                });
+
+            auto dev = queue.get_info<cl::sycl::info::queue::device>();
+
+            // Tree reduction requires power of two work-groups, which must also fit into local memory
+            const std::size_t max_wgs = prev_pow2(std::min({ device_max_wgs_for_kernel<KernelName>(queue),
+                                                             device_max_wgs_for_kernel<FirstKernelName>(queue),
+                                                             static_cast<std::size_t>(dev.get_info<cl::sycl::info::device::local_mem_size>() / sizeof(T)) }));
+
+            // Reproducible results require the very same reduction tree on every device, hence a fixed work-group size
+            // and tile. (Results of the sub-group policy still depend on the sub-group size of the device.)
+            if (load == reduction::load::reproducible && max_wgs < reproducible_wgs)
+                throw std::runtime_error{ "Device cannot launch reproducible reduction work-groups." };
+
+            const std::size_t wgs = load == reduction::load::reproducible ?
+                reproducible_wgs :
+                prev_pow2(std::min(work_group_size, max_wgs));
+
+            // Enough work-groups to saturate every compute unit a few times over
+            const std::size_t max_groups = 4 * dev.get_info<cl::sycl::info::device::max_compute_units>();
+
+            auto pass_tile = [=](std::size_t length) -> std::size_t
+            {
+                switch (load)
+                {
+                case reduction::load::element_per_item: return wgs;
+                case reduction::load::grid_stride: return std::max(wgs, reduced_length(reduced_length(length, max_groups), wgs) * wgs);
+                default: return reproducible_wgs * reproducible_items;
+                }
+            };
+            auto pass_groups = [=](std::size_t length) { return reduced_length(length, pass_tile(length)); };
+
+            if (pass_groups(length) == 1) // Single-pass reduction
+                return in_place_reduce<FirstKernelName>(Policy{}, queue, source, result, length, pass_tile(length), wgs, zero, f);
+
+            // Multi-pass reduction
+            //
+            // NOTE: the first pass produces the most partial results, the second one the second most. Every later
+            //       pass fits into whichever sub-buffer it is not reading from, so two sub-buffers suffice for
+            //       ping-ponging. The offset of the second sub-buffer must honor CL_DEVICE_MEM_BASE_ADDR_ALIGN (in bits),
+            //       while being a whole number of elements, hence it is a multiple of both.
+            const std::size_t first = pass_groups(length),
+                              second = pass_groups(first),
+                              align = lcm(std::max<std::size_t>(1, dev.get_info<cl::sycl::info::device::mem_base_addr_align>() / 8), sizeof(T)) / sizeof(T),
+                              offset = (first + align - 1) / align * align;
+
+            cl::sycl::buffer<T> temp{ cl::sycl::range<1>{ offset + second } };
+            cl::sycl::buffer<T> temp_sub1{ temp, cl::sycl::id<1>{ 0 }, cl::sycl::range<1>{ first } },
+                                temp_sub2{ temp, cl::sycl::id<1>{ offset }, cl::sycl::range<1>{ second } };
+
+            in_place_reduce<FirstKernelName>(Policy{}, queue, source, temp_sub1, length, pass_tile(length), wgs, zero, f);
+
+            for (length = first ; pass_groups(length) > 1 ; length = pass_groups(length))
+            {
+                in_place_reduce<KernelName>(Policy{}, queue, temp_sub1, temp_sub2, length, pass_tile(length), wgs, zero, f);
+                std::swap(temp_sub1, temp_sub2);
+            }
+
+            return in_place_reduce<KernelName>(Policy{}, queue, temp_sub1, result, length, pass_tile(length), wgs, zero, f); // Last pass writes to 'result' instead of 'temp'
         }
     }
-}
\ No newline at end of file
+}
+
+/// <summary>Performs a reduction operation on the provided dataset in a non-destructive manner. Result is written to <c>result[0]</c>.</summary>
+/// <note><c>zero</c> must be the identity element of <c>f</c>, as inputs are padded with it to a multiple of the work-group size.</note>
+/// <note>In <c>reduction::load::grid_stride</c> mode the first pass leaves only a few partial results per compute unit,
+///       turning large multi-pass reductions into one or two passes.</note>
+/// <note>In <c>reduction::load::reproducible</c> mode the shape of the reduction tree depends only on the length of the
+///       input, so with the hierarchical policy floating-point results are bit-identical across devices and runs
+///       (given IEEE-conformant <c>f</c>, eg. no denormal flushing). <c>work_group_size</c> is ignored.</note>
+/// <note><c>Policy</c> selects how the work-group local tree is carried out, see <c>reduction::hierarchical</c> and <c>reduction::sub_group</c> (if enabled).</note>
+/// <returns>Event of the final reduction pass.</returns>
+///
+template <typename KernelName,
+          typename Policy = reduction::hierarchical,
+          typename T,
+          typename F>
+cl::sycl::event reduce(cl::sycl::queue queue,
+                       T zero,
+                       F f,
+                       cl::sycl::buffer<T> source,
+                       cl::sycl::buffer<T> result,
+                       std::size_t work_group_size = std::numeric_limits<std::size_t>::max(),
+                       reduction::load load = reduction::load::grid_stride)
+{
+    return impl::reduce::multi_pass_reduce<KernelName, KernelName, Policy>(queue, zero, f, source, source.get_count(), result, work_group_size, load);
+}
+
+/// <summary>Reduces a buffer-like <c>source</c> using <c>f</c>. Result is written to <c>result[0]</c>.</summary>
+/// <note><c>Source</c> provides <c>get_count()</c> and <c>get_access<Mode>(cgh, range)</c> returning an object indexable
+///       by <c>std::size_t</c>, such as the lazy expressions of SYCL-LazySAXPY. Elements are computed on load inside the
+///       first pass, hence <c>source</c> is never written to global memory.</note>
+/// <note>See <c>reduce</c> for the meaning of the remaining parameters.</note>
+/// <returns>Event of the final reduction pass.</returns>
+///
+template <typename KernelName,
+          typename Policy = reduction::hierarchical,
+          typename T,
+          typename F,
+          typename Source>
+cl::sycl::event reduce(cl::sycl::queue queue,
+                       T zero,
+                       F f,
+                       Source source,
+                       cl::sycl::buffer<T> result,
+                       std::size_t work_group_size = std::numeric_limits<std::size_t>::max(),
+                       reduction::load load = reduction::load::grid_stride)
+{
+    using namespace impl::reduce;
+
+    return multi_pass_reduce<KernelName, first_pass<KernelName>, Policy>(queue, zero, f, source, source.get_count(), result, work_group_size, load);
+}
+
+/// <summary>Reduces <c>op(source[i])</c> using <c>f</c> without materializing the transformed dataset. Result is written to <c>result[0]</c>.</summary>
+/// <note>See <c>reduce</c> for the meaning of the remaining parameters.</note>
+/// <returns>Event of the final reduction pass.</returns>
+///
+template <typename KernelName,
+          typename Policy = reduction::hierarchical,
+          typename T,
+          typename F,
+          typename UnaryOp,
+          typename U>
+cl::sycl::event transform_reduce(cl::sycl::queue queue,
+                                 T zero,
+                                 F f,
+                                 UnaryOp op,
+                                 cl::sycl::buffer<U> source,
+                                 cl::sycl::buffer<T> result,
+                                 std::size_t work_group_size = std::numeric_limits<std::size_t>::max(),
+                                 reduction::load load = reduction::load::grid_stride)
+{
+    using namespace impl::reduce;
+
+    return multi_pass_reduce<KernelName, first_pass<KernelName>, Policy>(queue,
+                                                                         zero,
+                                                                         f,
+                                                                         unary_transform_buffer<U, UnaryOp>{ source, op },
+                                                                         source.get_count(),
+                                                                         result,
+                                                                         work_group_size,
+                                                                         load);
+}
+
+/// <summary>Reduces <c>op(x[i], y[i])</c> using <c>f</c> without materializing the transformed dataset, reading
+///          both inputs exactly once (eg. dot product). Result is written to <c>result[0]</c>.</summary>
+/// <precondition><c>x.get_count() == y.get_count()</c></precondition>
+/// <note>See <c>reduce</c> for the meaning of the remaining parameters.</note>
+/// <returns>Event of the final reduction pass.</returns>
+///
+template <typename KernelName,
+          typename Policy = reduction::hierarchical,
+          typename T,
+          typename F,
+          typename BinaryOp,
+          typename U1,
+          typename U2>
+cl::sycl::event transform_reduce(cl::sycl::queue queue,
+                                 T zero,
+                                 F f,
+                                 BinaryOp op,
+                                 cl::sycl::buffer<U1> x,
+                                 cl::sycl::buffer<U2> y,
+                                 cl::sycl::buffer<T> result,
+                                 std::size_t work_group_size = std::numeric_limits<std::size_t>::max(),
+                                 reduction::load load = reduction::load::grid_stride)
+{
+    using namespace impl::reduce;
+
+    return multi_pass_reduce<KernelName, first_pass<KernelName>, Policy>(queue,
+                                                                         zero,
+                                                                         f,
+                                                                         binary_transform_buffer<U1, U2, BinaryOp>{ x, y, op },
+                                                                         x.get_count(),
+                                                                         result,
+                                                                         work_group_size,
+                                                                         load);
+}
+
+/// <summary>Performs a segmented reduction, folding every segment [<c>offsets[s]</c>;<c>offsets[s + 1]</c>) of
+///          <c>source</c> using <c>f</c> into <c>result[s]</c>. Empty segments yield <c>zero</c>.</summary>
+/// <precondition><c>offsets</c> is non-decreasing, <c>offsets[0] == 0</c> and <c>offsets[result.get_count()] == source.get_count()</c></precondition>
+/// <note>Work is balanced by splitting the input (not the segments) into equal tiles of <c>tile_per_item</c> elements
+///       per work-item, one tile per work-group. Inside a tile, segments shorter than a work-group are folded by a single
+///       work-item each, longer ones cooperatively by the whole work-group. A second, light kernel combines the partial
+///       results of segments spanning multiple tiles, touching only <c>tiles + segments</c> elements.</note>
+/// <returns>Event of the final kernel.</returns>
+///
+template <typename KernelName,
+          typename T,
+          typename F,
+          typename Index>
+cl::sycl::event segmented_reduce(cl::sycl::queue queue,
+                                 T zero,
+                                 F f,
+                                 cl::sycl::buffer<T> source,
+                                 cl::sycl::buffer<Index> offsets,
+                                 cl::sycl::buffer<T> result,
+                                 std::size_t work_group_size = std::numeric_limits<std::size_t>::max(),
+                                 std::size_t tile_per_item = 16)
+{
+    using namespace impl::reduce;
+
+    auto dev = queue.get_info<cl::sycl::info::queue::device>();
+
+    const std::size_t wgs = prev_pow2(std::min({ work_group_size,
+                                                 device_max_wgs_for_kernel<KernelName>(queue),
+                                                 static_cast<std::size_t>(dev.get_info<cl::sycl::info::device::local_mem_size>() / (sizeof(T) + sizeof(Index))) }));
+
+    const std::size_t length = source.get_count(),
+                      segments = result.get_count(),
+                      tile = wgs * tile_per_item,
+                      tiles = reduced_length(length, tile);
+
+    // No segments (hence no input either), no kernel is launched
+    if (segments == 0) return cl::sycl::event{};
+
+    // Partial result of tile 'g' for segment 's' resides at 'g + s'. Segments touched by consecutive tiles
+    // overlap in at most one segment, hence indices are unique and never exceed 'tiles + segments'.
+    cl::sycl::buffer<T> partials{ cl::sycl::range<1>{ tiles + segments } };
+
+    if (tiles != 0) queue.submit([&](cl::sycl::handler& cgh)
+    {
+        auto local = cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local>{ cl::sycl::range<1>{ wgs }, cgh };
+        auto long_segments = cl::sycl::accessor<Index, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local>{ cl::sycl::range<1>{ tile_per_item }, cgh };
+        auto long_count = cl::sycl::accessor<cl::sycl::cl_uint, 1, cl::sycl::access::mode::atomic, cl::sycl::access::target::local>{ cl::sycl::range<1>{ 1 }, cgh };
+        auto src = source.template get_access<cl::sycl::access::mode::read>(cgh);
+        auto offs = offsets.template get_access<cl::sycl::access::mode::read>(cgh);
+        auto part = partials.template get_access<cl::sycl::access::mode::discard_write>(cgh);
+
+        cgh.parallel_for<KernelName>(cl::sycl::nd_range<1>{ cl::sycl::range<1>{ tiles * wgs }, cl::sycl::range<1>{ wgs } }, [=](cl::sycl::nd_item<1> item)
+        {
+            const std::size_t lid = item.get_local_id(0),
+                              grp = item.get_group(0),
+                              tile_begin = grp * tile,
+                              tile_end = tile_begin + tile < length ? tile_begin + tile : length;
+
+            // Segments intersecting the tile and their intersection with it
+            const std::size_t first = last_not_greater(offs, 0, segments + 1, tile_begin),
+                              last = last_not_greater(offs, first, segments + 1 - first, tile_end - 1);
+
+            auto begin = [=](std::size_t s) { return static_cast<std::size_t>(offs[s]) > tile_begin ? static_cast<std::size_t>(offs[s]) : tile_begin; };
+            auto end = [=](std::size_t s) { return static_cast<std::size_t>(offs[s + 1]) < tile_end ? static_cast<std::size_t>(offs[s + 1]) : tile_end; };
+
+            if (lid == 0) long_count[0].store(0u);
+
+            item.barrier(cl::sycl::access::fence_space::local_space);
+
+            // Short segments: one work-item each, long ones are deferred to the whole work-group
+            for (std::size_t s = first + lid ; s <= last ; s += wgs)
+            {
+                if (end(s) - begin(s) < wgs)
+                    part[grp + s] = strided_fold(src, begin(s), end(s), 1, zero, f);
+                else
+                    long_segments[long_count[0].fetch_add(1u)] = static_cast<Index>(s);
+            }
+
+            item.barrier(cl::sycl::access::fence_space::local_space);
+
+            // Long segments: at most 'tile_per_item' of them fit into a tile
+            const cl::sycl::cl_uint count = long_count[0].load();
+
+            for (cl::sycl::cl_uint j = 0 ; j < count ; ++j)
+            {
+                const std::size_t s = long_segments[j];
+
+                local[lid] = strided_fold(src, begin(s) + lid, end(s), wgs, zero, f);
+
+                in_place_reduce(item, local, f);
+
+                if (lid == 0)
+                    part[grp + s] = local[0];
+            }
+        });
+    });
+
+    return queue.submit([&](cl::sycl::handler& cgh)
+    {
+        auto offs = offsets.template get_access<cl::sycl::access::mode::read>(cgh);
+        auto part = partials.template get_access<cl::sycl::access::mode::read>(cgh);
+        auto res = result.template get_access<cl::sycl::access::mode::discard_write>(cgh);
+
+        cgh.parallel_for<segment_fixup<KernelName>>(cl::sycl::range<1>{ segments }, [=](cl::sycl::item<1> i)
+        {
+            const std::size_t s = i.get_id(0),
+                              b = offs[s],
+                              e = offs[s + 1];
+            T acc = zero;
+
+            if (b != e) for (std::size_t g = b / tile ; g <= (e - 1) / tile ; ++g)
+                acc = f(acc, part[g + s]);
+
+            res[i] = acc;
+        });
+    });
+}
+
+/// <summary>Finds the smallest element of <c>source</c>, written to <c>result[0]</c> along with its index.
+///          Of equal elements the one with the lowest index is selected.</summary>
+/// <note>Indices are generated while loading the first pass and carried through every later one.
+///       See <c>reduce</c> for the meaning of the remaining parameters.</note>
+/// <returns>Event of the final reduction pass.</returns>
+///
+template <typename KernelName,
+          typename Policy = reduction::hierarchical,
+          typename T>
+cl::sycl::event arg_min(cl::sycl::queue queue,
+                        cl::sycl::buffer<T> source,
+                        cl::sycl::buffer<reduction::indexed<T>> result,
+                        std::size_t work_group_size = std::numeric_limits<std::size_t>::max(),
+                        reduction::load load = reduction::load::grid_stride)
+{
+    using namespace impl::reduce;
+
+    return multi_pass_reduce<KernelName, first_pass<KernelName>, Policy>(queue,
+                                                                         reduction::indexed<T>{ std::numeric_limits<T>::max(), std::numeric_limits<std::uint64_t>::max() },
+                                                                         arg_select<false>{},
+                                                                         indexing_buffer<T>{ source },
+                                                                         source.get_count(),
+                                                                         result,
+                                                                         work_group_size,
+                                                                         load);
+}
+
+/// <summary>Finds the largest element of <c>source</c>, written to <c>result[0]</c> along with its index.
+///          Of equal elements the one with the lowest index is selected.</summary>
+/// <note>See <c>arg_min</c>.</note>
+/// <returns>Event of the final reduction pass.</returns>
+///
+template <typename KernelName,
+          typename Policy = reduction::hierarchical,
+          typename T>
+cl::sycl::event arg_max(cl::sycl::queue queue,
+                        cl::sycl::buffer<T> source,
+                        cl::sycl::buffer<reduction::indexed<T>> result,
+                        std::size_t work_group_size = std::numeric_limits<std::size_t>::max(),
+                        reduction::load load = reduction::load::grid_stride)
+{
+    using namespace impl::reduce;
+
+    return multi_pass_reduce<KernelName, first_pass<KernelName>, Policy>(queue,
+                                                                         reduction::indexed<T>{ std::numeric_limits<T>::lowest(), std::numeric_limits<std::uint64_t>::max() },
+                                                                         arg_select<true>{},
+                                                                         indexing_buffer<T>{ source },
+                                                                         source.get_count(),
+                                                                         result,
+                                                                         work_group_size,
+                                                                         load);
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+// SYCL include
+#include <CL/sycl.hpp>
+
+#include "Reduce.hpp"
+
+// Standard C++ includes
+#include <cstddef>      // std::size_t
+#include <algorithm>    // std::min
+#include <limits>       // std::numeric_limits
+
+
+namespace impl
+{
+    namespace scan
+    {
+        /// <summary>Kernel name of the pass computing per work-group sums of a scan level.</summary>
+        ///
+        template <typename KernelName> class block_sums;
+
+        /// <summary>Performs work-efficient (Blelloch) exclusive scan of <c>local</c> using the binary operator <c>f</c>,
+        ///          to be called by every work-item of the work-group.</summary>
+        /// <precondition><c>item.get_local_range().get(0)</c> is a power of two and equals <c>local.get_range().get(0)</c></precondition>
+        /// <note>Operands are always combined in input order, hence <c>f</c> need not be commutative.</note>
+        ///
+        template <typename F, typename T>
+        void local_exclusive_scan(cl::sycl::nd_item<1> item,
+                                  cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local> local,
+                                  T zero,
+                                  F f)
+        {
+            const std::size_t lid = item.get_local_id(0),
+                              n = item.get_local_range().get(0);
+
+            // Up-sweep: build partial sums of sub-trees in place
+            for (std::size_t d = 1 ; d < n ; d *= 2)
+            {
+                item.barrier(cl::sycl::access::fence_space::local_space);
+
+                const std::size_t i = (lid + 1) * 2 * d - 1;
+
+                if (i < n)
+                    local[i] = f(local[i - d], local[i]);
+            }
+
+            // Only work-item 0 wrote the root during the last up-sweep step
+            if (lid == 0) local[n - 1] = zero;
+
+            // Down-sweep: left child inherits the prefix of its parent, right child also the sum of its sibling
+            for (std::size_t d = n / 2 ; d > 0 ; d /= 2)
+            {
+                item.barrier(cl::sycl::access::fence_space::local_space);
+
+                const std::size_t i = (lid + 1) * 2 * d - 1;
+
+                if (i < n)
+                {
+                    const T left = local[i - d];
+
+                    local[i - d] = local[i];
+                    local[i] = f(local[i], left);
+                }
+            }
+
+            item.barrier(cl::sycl::access::fence_space::local_space);
+        }
+
+        /// <summary>Enqueues scanning consecutive blocks of <c>wgs</c> elements of <c>from</c> into <c>to</c>. If
+        ///          <c>has_offsets</c> is set, every block is prefixed by the matching element of <c>offsets</c>.</summary>
+        ///
+        template <typename KernelName, typename T, typename F>
+        cl::sycl::event block_scan(cl::sycl::queue queue,
+                                   cl::sycl::buffer<T> from,
+                                   cl::sycl::buffer<T> to,
+                                   cl::sycl::buffer<T> offsets,
+                                   std::size_t length,
+                                   std::size_t wgs,
+                                   T zero,
+                                   F f,
+                                   bool inclusive,
+                                   bool has_offsets)
+        {
+            const std::size_t groups = impl::reduce::reduced_length(length, wgs);
+
+            return queue.submit([&](cl::sycl::handler& cgh)
+            {
+                auto local = cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local>{ cl::sycl::range<1>{ wgs }, cgh };
+                auto src = from.template get_access<cl::sycl::access::mode::read>(cgh, cl::sycl::range<1>{ length });
+                auto dst = to.template get_access<cl::sycl::access::mode::discard_write>(cgh, cl::sycl::range<1>{ length });
+                auto off = offsets.template get_access<cl::sycl::access::mode::read>(cgh);
+
+                cgh.parallel_for<KernelName>(cl::sycl::nd_range<1>{ cl::sycl::range<1>{ groups * wgs }, cl::sycl::range<1>{ wgs } }, [=](cl::sycl::nd_item<1> item)
+                {
+                    const std::size_t gid = item.get_global_id(0),
+                                      lid = item.get_local_id(0);
+                    const T x = gid < length ? src[gid] : zero;
+
+                    local[lid] = x;
+
+                    local_exclusive_scan(item, local, zero, f);
+
+                    const T prefix = has_offsets ? f(off[item.get_group(0)], local[lid]) : local[lid];
+
+                    if (gid < length)
+                        dst[gid] = inclusive ? f(prefix, x) : prefix;
+                });
+            });
+        }
+
+        /// <summary>Scans the first <c>length</c> elements of <c>from</c> into <c>to</c> (reduce-then-scan).</summary>
+        /// <note>Inputs longer than one work-group are reduced per block, the block sums are exclusively scanned
+        ///       recursively, then every block is scanned again, prefixed by its offset. This takes
+        ///       O(log_wgs(length)) levels, each reading the input of its level twice.</note>
+        ///
+        template <typename KernelName, typename T, typename F>
+        cl::sycl::event scan_level(cl::sycl::queue queue,
+                                   T zero,
+                                   F f,
+                                   cl::sycl::buffer<T> from,
+                                   cl::sycl::buffer<T> to,
+                                   std::size_t length,
+                                   std::size_t wgs,
+                                   bool inclusive)
+        {
+            using namespace impl::reduce;
+
+            // Nothing to scan, no kernel is launched
+            if (length == 0) return cl::sycl::event{};
+
+            const std::size_t groups = reduced_length(length, wgs);
+
+            if (groups == 1) // Offsets are never read, but a valid buffer must be bound
+                return block_scan<KernelName>(queue, from, to, cl::sycl::buffer<T>{ cl::sycl::range<1>{ 1 } }, length, wgs, zero, f, inclusive, false);
+
+            cl::sycl::buffer<T> sums{ cl::sycl::range<1>{ groups } },
+                                offsets{ cl::sycl::range<1>{ groups } };
+
+            in_place_reduce<block_sums<KernelName>>(reduction::hierarchical{}, queue, from, sums, length, wgs, wgs, zero, f);
+
+            scan_level<KernelName>(queue, zero, f, sums, offsets, groups, wgs, false);
+
+            return block_scan<KernelName>(queue, from, to, offsets, length, wgs, zero, f, inclusive, true);
+        }
+
+        template <typename KernelName, typename T, typename F>
+        cl::sycl::event scan(cl::sycl::queue queue,
+                             T zero,
+                             F f,
+                             cl::sycl::buffer<T> source,
+                             cl::sycl::buffer<T> result,
+                             std::size_t work_group_size,
+                             bool inclusive)
+        {
+            using namespace impl::reduce;
+
+            auto dev = queue.get_info<cl::sycl::info::queue::device>();
+
+            const std::size_t wgs = prev_pow2(std::min({ work_group_size,
+                                                         device_max_wgs_for_kernel<KernelName>(queue),
+                                                         device_max_wgs_for_kernel<block_sums<KernelName>>(queue),
+                                                         static_cast<std::size_t>(dev.get_info<cl::sycl::info::device::local_mem_size>() / sizeof(T)) }));
+
+            return scan_level<KernelName>(queue, zero, f, source, result, source.get_count(), wgs, inclusive);
+        }
+    }
+}
+
+/// <summary>Computes <c>result[i] = f(source[0], ..., source[i])</c>.</summary>
+/// <precondition><c>source</c> and <c>result</c> are distinct buffers of equal length.</precondition>
+/// <note><c>zero</c> must be the identity element of <c>f</c>, as inputs are padded with it to a multiple of the work-group size.</note>
+/// <returns>Event of the final scan pass.</returns>
+///
+template <typename KernelName,
+          typename T,
+          typename F>
+cl::sycl::event inclusive_scan(cl::sycl::queue queue,
+                               T zero,
+                               F f,
+                               cl::sycl::buffer<T> source,
+                               cl::sycl::buffer<T> result,
+                               std::size_t work_group_size = std::numeric_limits<std::size_t>::max())
+{
+    return impl::scan::scan<KernelName>(queue, zero, f, source, result, work_group_size, true);
+}
+
+/// <summary>Computes <c>result[i] = f(zero, source[0], ..., source[i - 1])</c>, hence <c>result[0] = zero</c>.</summary>
+/// <precondition><c>source</c> and <c>result</c> are distinct buffers of equal length.</precondition>
+/// <note><c>zero</c> must be the identity element of <c>f</c>, as inputs are padded with it to a multiple of the work-group size.</note>
+/// <returns>Event of the final scan pass.</returns>
+///
+template <typename KernelName,
+          typename T,
+          typename F>
+cl::sycl::event exclusive_scan(cl::sycl::queue queue,
+                               T zero,
+                               F f,
+                               cl::sycl::buffer<T> source,
+                               cl::sycl::buffer<T> result,
+                               std::size_t work_group_size = std::numeric_limits<std::size_t>::max())
+{
+    return impl::scan::scan<KernelName>(queue, zero, f, source, result, work_group_size, false);
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+// SYCL include
+#include <CL/sycl.hpp>
+
+#include "Reduce.hpp"
+
+// Standard C++ includes
+#include <cstddef>      // std::size_t
+#include <algorithm>    // std::min
+#include <limits>       // std::numeric_limits
+#include <tuple>        // std::tuple, std::get, std::make_tuple
+#include <utility>      // std::index_sequence
+
+
+namespace reduction
+{
+    /// <summary>Returns its argument unchanged.</summary>
+    ///
+    struct identity
+    {
+        template <typename U>
+        U operator()(U x) const { return x; }
+    };
+
+    /// <summary>One reduction of a tuple reduction: folds <c>transform(x)</c> of every element using <c>f</c>, starting from <c>zero</c>.</summary>
+    ///
+    template <typename T, typename F, typename Transform>
+    struct op
+    {
+        using value_type = T;
+
+        T zero;
+        F f;
+        Transform transform;
+    };
+
+    template <typename T, typename F>
+    op<T, F, identity> make_op(T zero, F f) { return { zero, f, identity{} }; }
+
+    template <typename T, typename F, typename Transform>
+    op<T, F, Transform> make_op(T zero, F f, Transform transform) { return { zero, f, transform }; }
+}
+
+namespace impl
+{
+    namespace tuple_reduce
+    {
+        /// <summary>Kernel name of the pass combining the partial results of a tuple reduction.</summary>
+        ///
+        template <typename KernelName> class final_pass;
+
+        /// <summary>Enqueues one pass of a tuple reduction, folding the first <c>length</c> loaded tuples into <c>groups</c>
+        ///          partial results per operation, written to the front of the matching buffer of <c>to</c>.</summary>
+        /// <note><c>make_loader(cgh)</c> must return a callable mapping an index to the tuple of (transformed) inputs.
+        ///       Local memory is laid out as one array per operation (struct-of-arrays), so that consecutive work-items
+        ///       touch consecutive addresses of every array.</note>
+        ///
+        template <typename KernelName, typename Ops, typename MakeLoader, typename Results, std::size_t... Is>
+        cl::sycl::event tuple_pass(cl::sycl::queue queue,
+                                   Ops ops,
+                                   MakeLoader make_loader,
+                                   Results to,
+                                   std::size_t length,
+                                   std::size_t groups,
+                                   std::size_t wgs,
+                                   std::index_sequence<Is...>)
+        {
+            return queue.submit([&](cl::sycl::handler& cgh)
+            {
+                auto locals = std::make_tuple(cl::sycl::accessor<typename std::tuple_element<Is, Ops>::type::value_type, 1, cl::sycl::access::mode::read_write, cl::sycl::access::target::local>{ cl::sycl::range<1>{ wgs }, cgh }...);
+                auto dsts = std::make_tuple(std::get<Is>(to).template get_access<cl::sycl::access::mode::discard_write>(cgh, cl::sycl::range<1>{ groups })...);
+                auto load = make_loader(cgh);
+
+                cgh.parallel_for<KernelName>(cl::sycl::nd_range<1>{ cl::sycl::range<1>{ groups * wgs }, cl::sycl::range<1>{ wgs } }, [=](cl::sycl::nd_item<1> item)
+                {
+                    const std::size_t lid = item.get_local_id(0);
+
+                    auto acc = std::make_tuple(std::get<Is>(ops).zero...);
+
+                    for (std::size_t i = item.get_global_id(0) ; i < length ; i += groups * wgs)
+                    {
+                        const auto x = load(i);
+
+                        acc = std::make_tuple(std::get<Is>(ops).f(std::get<Is>(acc), std::get<Is>(x))...);
+                    }
+
+                    {
+                        int dummy[] = { 0, (std::get<Is>(locals)[lid] = std::get<Is>(acc), 0)... };
+                        (void)dummy;
+                    }
+
+                    // Every level folds all operations, hence one barrier per level regardless of their count
+                    for (std::size_t I = wgs / 2 ; I > 0 ; I /= 2)
+                    {
+                        item.barrier(cl::sycl::access::fence_space::local_space);
+
+                        if (lid < I)
+                        {
+                            int dummy[] = { 0, (std::get<Is>(locals)[lid] = std::get<Is>(ops).f(std::get<Is>(locals)[lid], std::get<Is>(locals)[lid + I]), 0)... };
+                            (void)dummy;
+                        }
+                    }
+
+                    if (lid == 0)
+                    {
+                        int dummy[] = { 0, (std::get<Is>(dsts)[item.get_group(0)] = std::get<Is>(locals)[0], 0)... };
+                        (void)dummy;
+                    }
+                });
+            });
+        }
+
+        template <typename KernelName, typename U, typename... Ops, typename... Ts, std::size_t... Is>
+        cl::sycl::event reduce_tuple(cl::sycl::queue queue,
+                                     std::tuple<Ops...> ops,
+                                     cl::sycl::buffer<U> source,
+                                     std::tuple<cl::sycl::buffer<Ts>...> results,
+                                     std::size_t work_group_size,
+                                     std::index_sequence<Is...> seq)
+        {
+            using namespace impl::reduce;
+
+            auto dev = queue.get_info<cl::sycl::info::queue::device>();
+
+            std::size_t bytes_per_item = 0;
+            for (auto size : { sizeof(Ts)... }) bytes_per_item += size;
+
+            const std::size_t wgs = prev_pow2(std::min({ work_group_size,
+                                                         device_max_wgs_for_kernel<KernelName>(queue),
+                                                         device_max_wgs_for_kernel<final_pass<KernelName>>(queue),
+                                                         static_cast<std::size_t>(dev.get_info<cl::sycl::info::device::local_mem_size>() / bytes_per_item) }));
+
+            const std::size_t length = source.get_count(),
+                              groups = std::min<std::size_t>(reduced_length(length, wgs), 4 * dev.get_info<cl::sycl::info::device::max_compute_units>());
+
+            // Source is read once, every operation folds its own transform of the same element
+            auto source_loader = [=](cl::sycl::handler& cgh) mutable
+            {
+                auto src = source.template get_access<cl::sycl::access::mode::read>(cgh, cl::sycl::range<1>{ length });
+
+                return [=](std::size_t i)
+                {
+                    const auto x = src[i];
+
+                    return std::make_tuple(std::get<Is>(ops).transform(x)...);
+                };
+            };
+
+            if (groups == 1) // Single-pass reduction
+                return tuple_pass<KernelName>(queue, ops, source_loader, results, length, 1, wgs, seq);
+
+            auto partials = std::make_tuple(cl::sycl::buffer<Ts>{ cl::sycl::range<1>{ groups } }...);
+
+            tuple_pass<KernelName>(queue, ops, source_loader, partials, length, groups, wgs, seq);
+
+            // Grid-stride first pass leaves few enough partial results for a single work-group
+            return tuple_pass<final_pass<KernelName>>(queue, ops, [=](cl::sycl::handler& cgh) mutable
+            {
+                auto parts = std::make_tuple(std::get<Is>(partials).template get_access<cl::sycl::access::mode::read>(cgh)...);
+
+                return [=](std::size_t i) { return std::make_tuple(std::get<Is>(parts)[i]...); };
+            }, results, groups, 1, wgs, seq);
+        }
+    }
+}
+
+/// <summary>Performs multiple reductions of the same dataset while reading it only once. The result of
+///          <c>std::get<I>(ops)</c> is written to <c>std::get<I>(results)[0]</c>.</summary>
+/// <note>Operations are created using <c>reduction::make_op</c>. Every <c>zero</c> must be the identity element of
+///       the matching <c>f</c>. The optional transform of an operation allows folding values of a different type
+///       than the source, eg. to count elements.</note>
+/// <returns>Event of the final reduction pass.</returns>
+///
+template <typename KernelName,
+          typename U,
+          typename... Ops,
+          typename... Ts>
+cl::sycl::event reduce_tuple(cl::sycl::queue queue,
+                             std::tuple<Ops...> ops,
+                             cl::sycl::buffer<U> source,
+                             std::tuple<cl::sycl::buffer<Ts>...> results,
+                             std::size_t work_group_size = std::numeric_limits<std::size_t>::max())
+{
+    static_assert(sizeof...(Ops) == sizeof...(Ts), "Every operation needs exactly one result buffer.");
+
+    return impl::tuple_reduce::reduce_tuple<KernelName>(queue, ops, source, results, work_group_size, std::index_sequence_for<Ops...>{});
+}
@@ -26,7 +26,56 @@ namespace util
     }
 }
 
-namespace kernels { class saxpy; }
+namespace kernels { class saxpy; template <int N> class saxpy_vec; }
+
+/// <summary>Enqueues <c>y = a * x + y</c>, every work-item processing <c>N</c> consecutive elements using vector
+///          loads and stores. The work-item owning the partial block at the end of the input (if any) falls back
+///          to scalar code.</summary>
+///
+template <int N>
+cl::sycl::event saxpy_vec(cl::sycl::queue queue, float a, cl::sycl::buffer<float> buf_x, cl::sycl::buffer<float> buf_y)
+{
+    const std::size_t length = buf_x.get_count();
+
+    return queue.submit([&](cl::sycl::handler& cgh)
+    {
+        auto x = buf_x.get_access<cl::sycl::access::mode::read>(cgh);
+        auto y = buf_y.get_access<cl::sycl::access::mode::read_write>(cgh);
+
+        cgh.parallel_for<kernels::saxpy_vec<N>>(cl::sycl::range<1>{ (length + N - 1) / N }, [=](cl::sycl::item<1> i)
+        {
+            const std::size_t id = i.get_linear_id(),
+                              first = id * N;
+
+            if (first + N <= length)
+            {
+                cl::sycl::vec<float, N> vx, vy;
+
+                vx.load(id, x.get_pointer());
+                vy.load(id, y.get_pointer());
+
+                (a * vx + vy).store(id, y.get_pointer());
+            }
+            else
+                for (std::size_t j = first ; j < length ; ++j)
+                    y[j] = a * x[j] + y[j];
+        });
+    });
+}
+
+/// <summary>Dispatches to the vectorised SAXPY of matching <c>width</c>.</summary>
+/// <precondition><c>width</c> is one of 2, 4, 8 or 16.</precondition>
+///
+cl::sycl::event saxpy_vec(std::size_t width, cl::sycl::queue queue, float a, cl::sycl::buffer<float> x, cl::sycl::buffer<float> y)
+{
+    switch (width)
+    {
+    case 2: return saxpy_vec<2>(queue, a, x, y);
+    case 4: return saxpy_vec<4>(queue, a, x, y);
+    case 8: return saxpy_vec<8>(queue, a, x, y);
+    default: return saxpy_vec<16>(queue, a, x, y);
+    }
+}
 
 int main(int argc, char* argv[])
 {
@@ -93,7 +142,8 @@ int main(int argc, char* argv[])
                                     cl::sycl::property_list{} };
 
         cl::sycl::buffer<float> buf_x{ cl::sycl::range<1>{opts.length} },
-                                buf_y{ cl::sycl::range<1>{opts.length} };
+                                buf_y{ cl::sycl::range<1>{opts.length} },
+                                buf_y_vec{ cl::sycl::range<1>{opts.length} }; // Input of the vectorised variant
 
         std::valarray<float> arr_x(opts.length),
                              arr_y(opts.length);
@@ -106,13 +156,19 @@ int main(int argc, char* argv[])
         std::generate_n(std::begin(arr_x), opts.length, prng);
         std::generate_n(std::begin(arr_y), opts.length, prng);
 
-        // Initialize buffer
+        // Initialize buffers (inputs of the scalar kernel are dispatched explicitly, so their transfer can be timed)
+        auto upload_x = queue.submit([&](cl::sycl::handler& cgh)
         {
-            auto x = buf_x.get_access<cl::sycl::access::mode::write>();
-            auto y = buf_y.get_access<cl::sycl::access::mode::write>();
+            cgh.copy(&arr_x[0], buf_x.get_access<cl::sycl::access::mode::discard_write>(cgh));
+        });
+        auto upload_y = queue.submit([&](cl::sycl::handler& cgh)
+        {
+            cgh.copy(&arr_y[0], buf_y.get_access<cl::sycl::access::mode::discard_write>(cgh));
+        });
+        {
+            auto y_vec = buf_y_vec.get_access<cl::sycl::access::mode::write>();
 
-            std::copy(std::begin(arr_x), std::end(arr_x), x.get_pointer());
-            std::copy(std::begin(arr_y), std::end(arr_y), y.get_pointer());
+            std::copy(std::begin(arr_y), std::end(arr_y), y_vec.get_pointer());
         }
 
         // Compute on device
@@ -129,6 +185,17 @@ int main(int argc, char* argv[])
 
         event.wait_and_throw(); // May use CPU as device
 
+        // Vectorised variant matching the preferred vector width of the device (if any)
+        const std::size_t width = dev.get_info<cl::sycl::info::device::preferred_vector_width_float>();
+        const bool vectorised = width == 2 || width == 4 || width == 8 || width == 16;
+
+        cl::sycl::event vec_event;
+        if (vectorised)
+        {
+            vec_event = saxpy_vec(width, queue, a, buf_x, buf_y_vec);
+            vec_event.wait_and_throw();
+        }
+
         // Compute validation set on host
         auto start = std::chrono::high_resolution_clock::now();
 
@@ -141,6 +208,16 @@ int main(int argc, char* argv[])
             std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() <<
             " us." << std::endl;
 
+        if (!opts.quiet && dev_supports_profiling) std::cout <<
+            "Host to device transfer took: " <<
+            (util::get_duration<cl::sycl::info::event_profiling::command_start,
+                                cl::sycl::info::event_profiling::command_end,
+                                std::chrono::microseconds>(upload_x) +
+             util::get_duration<cl::sycl::info::event_profiling::command_start,
+                                cl::sycl::info::event_profiling::command_end,
+                                std::chrono::microseconds>(upload_y)).count() <<
+            " us." << std::endl;
+
         if (!opts.quiet && dev_supports_profiling) std::cout <<
             "Device (kernel) execution took: " <<
             util::get_duration<cl::sycl::info::event_profiling::command_start,
@@ -148,6 +225,28 @@ int main(int argc, char* argv[])
                                std::chrono::microseconds>(event).count() <<
             " us." << std::endl;
 
+        if (!opts.quiet && dev_supports_profiling && vectorised) std::cout <<
+            "Device (float" << width << " kernel) execution took: " <<
+            util::get_duration<cl::sycl::info::event_profiling::command_start,
+                               cl::sycl::info::event_profiling::command_end,
+                               std::chrono::microseconds>(vec_event).count() <<
+            " us." << std::endl;
+
+        // Explicit fetch of results (reuse storage of arr_x)
+        auto download = queue.submit([&](cl::sycl::handler& cgh)
+        {
+            cgh.copy(buf_y.get_access<cl::sycl::access::mode::read>(cgh), &arr_x[0]);
+        });
+
+        download.wait_and_throw();
+
+        if (!opts.quiet && dev_supports_profiling) std::cout <<
+            "Device to host transfer took: " <<
+            util::get_duration<cl::sycl::info::event_profiling::command_start,
+                               cl::sycl::info::event_profiling::command_end,
+                               std::chrono::microseconds>(download).count() <<
+            " us." << std::endl;
+
         // Verify
         //
         // NOTE: host access implicitly synchronizes, meaning all operations pending on the
@@ -160,15 +259,19 @@ int main(int argc, char* argv[])
         //             sync points, and rationale for this change, see:
         //             sycl-1.2.1.pdf: p.30, section 3.6.5.1()
         {
-            auto acc_y = buf_y.get_access<cl::sycl::access::mode::read>();
-            auto acc_y_begin = acc_y.get_pointer(),
-                 acc_y_end = acc_y.get_pointer() + acc_y.get_count();
-
             auto markers = std::mismatch(std::begin(arr_y), std::end(arr_y),
-                                         acc_y_begin, acc_y_end);
+                                         std::begin(arr_x), std::end(arr_x));
 
-            if (markers.first != std::end(arr_y) || markers.second != acc_y_end)
+            if (markers.first != std::end(arr_y) || markers.second != std::end(arr_x))
                 throw std::runtime_error{ "Validation failed." };
+
+            if (vectorised)
+            {
+                auto acc_y_vec = buf_y_vec.get_access<cl::sycl::access::mode::read>();
+
+                if (!std::equal(std::begin(arr_y), std::end(arr_y), acc_y_vec.get_pointer()))
+                    throw std::runtime_error{ "Validation of vectorised variant failed." };
+            }
         }
 
         if (!opts.quiet) std::cout << "Result verification passed!" << std::endl;